@@ -0,0 +1,245 @@
+#include <tuple>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <bitstream/field.h>
+#include <bitstream/array.h>
+#include <bitstream/layout.h>
+
+
+using bitstream::Endianness;
+
+static const long fields = 4096;   // Decoded per iteration, keeps the buffer in L1/L2
+
+template <typename Field>
+struct Buffer {
+    static const long stride = Field::bytes_occupied + 1;  // Runtime buffer address, no constant folding
+
+    std::vector<char> data;
+    Buffer() : data(stride * fields + 8) {
+        for (unsigned long i = 0; i < data.size(); ++i) {
+            data[i] = char(i * 131 + 7);
+        }
+    }
+};
+
+
+template <typename Field>
+static void BM_FieldGet(benchmark::State &state) {
+    Buffer<Field> buffer;
+    for (auto _: state) {
+        typename Field::type sum = 0;
+        for (long i = 0; i < fields; ++i) {
+            sum += Field(buffer.data.data() + i * buffer.stride).value();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * fields);
+}
+
+template <typename Field>
+static void BM_FieldSet(benchmark::State &state) {
+    Buffer<Field> buffer;
+    for (auto _: state) {
+        for (long i = 0; i < fields; ++i) {
+            Field(buffer.data.data() + i * buffer.stride) = typename Field::type(i * 0x9E3779B97F4A7C15ULL);
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * fields);
+}
+
+#define BENCHMARK_FIELD(name, ...) \
+    BENCHMARK_TEMPLATE(BM_FieldGet, bitstream::Field<__VA_ARGS__>)->Name("Field/get/" name); \
+    BENCHMARK_TEMPLATE(BM_FieldSet, bitstream::Field<__VA_ARGS__>)->Name("Field/set/" name)
+
+// Aligned, register sized
+BENCHMARK_FIELD("aligned/le/u8",  8,  0, Endianness::little, unsigned);
+BENCHMARK_FIELD("aligned/le/u16", 16, 0, Endianness::little, unsigned);
+BENCHMARK_FIELD("aligned/le/u32", 32, 0, Endianness::little, unsigned);
+BENCHMARK_FIELD("aligned/le/u64", 64, 0, Endianness::little, unsigned);
+BENCHMARK_FIELD("aligned/be/u16", 16, 0, Endianness::big,    unsigned);
+BENCHMARK_FIELD("aligned/be/u32", 32, 0, Endianness::big,    unsigned);
+BENCHMARK_FIELD("aligned/be/u64", 64, 0, Endianness::big,    unsigned);
+
+// Unaligned, fitting a 64-bit word
+BENCHMARK_FIELD("unaligned/le/u13", 13, 3, Endianness::little, unsigned);
+BENCHMARK_FIELD("unaligned/be/u13", 13, 3, Endianness::big,    unsigned);
+BENCHMARK_FIELD("unaligned/le/u32", 32, 5, Endianness::little, unsigned);
+BENCHMARK_FIELD("unaligned/be/u32", 32, 5, Endianness::big,    unsigned);
+BENCHMARK_FIELD("unaligned/le/u57", 57, 7, Endianness::little, unsigned);
+BENCHMARK_FIELD("unaligned/be/u57", 57, 7, Endianness::big,    unsigned);
+
+// Extended, spanning more than 64 bits
+BENCHMARK_FIELD("extended/le/u62", 62, 3, Endianness::little, unsigned);
+BENCHMARK_FIELD("extended/be/u62", 62, 3, Endianness::big,    unsigned);
+BENCHMARK_FIELD("extended/le/u64", 64, 1, Endianness::little, unsigned);
+BENCHMARK_FIELD("extended/be/u64", 64, 1, Endianness::big,    unsigned);
+
+// Sign extension, bit field based for non register sizes
+BENCHMARK_FIELD("signed/be/s13", 13, 3, Endianness::big, signed);
+BENCHMARK_FIELD("signed/be/s32", 32, 0, Endianness::big, signed);
+BENCHMARK_FIELD("signed/be/s62", 62, 3, Endianness::big, signed);
+
+
+// Several fields of a header: each one on its own vs. one load for all of them
+template <typename... Fields>
+static void BM_FieldsGet(benchmark::State &state) {
+    Buffer<bitstream::Footprint<8 * bitstream::Layout<Fields...>::last>> buffer;
+    for (auto _: state) {
+        uint64_t sum = 0;
+        for (long i = 0; i < fields; ++i) {
+            const char *data = buffer.data.data() + i * buffer.stride;
+            sum += (uint64_t(Fields(data).value()) + ...);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * fields);
+}
+
+template <typename... Fields>
+static void BM_LayoutGet(benchmark::State &state) {
+    using Layout = bitstream::Layout<Fields...>;
+    Buffer<bitstream::Footprint<8 * Layout::last>> buffer;
+    for (auto _: state) {
+        uint64_t sum = 0;
+        for (long i = 0; i < fields; ++i) {
+            std::apply([&sum](auto... values) {
+                sum += (uint64_t(values) + ...);
+            }, Layout::get(buffer.data.data() + i * buffer.stride));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * fields);
+}
+
+#define BENCHMARK_LAYOUT(name, ...) \
+    BENCHMARK_TEMPLATE(BM_FieldsGet, __VA_ARGS__)->Name("Layout/fields/" name); \
+    BENCHMARK_TEMPLATE(BM_LayoutGet, __VA_ARGS__)->Name("Layout/layout/" name)
+
+namespace be = bitstream::be;
+namespace le = bitstream::le;
+
+BENCHMARK_LAYOUT("be/full_box", be::UInt8<0>, be::UInt<24, 8>);
+BENCHMARK_LAYOUT("be/4x64", be::UInt<4, 0>, be::UInt<12, 4>, be::Int<16, 16>, be::UInt32<32>);
+BENCHMARK_LAYOUT("le/4x64", le::UInt<4, 0>, le::UInt<12, 4>, le::Int<16, 16>, le::UInt32<32>);
+BENCHMARK_LAYOUT("be/6x48", be::UInt<1, 0>, be::UInt<7, 1>, be::UInt<3, 8>, be::UInt<13, 11>, be::UInt<2, 24>, be::Int<22, 26>);
+
+
+template <typename Field, long items>
+static void BM_StaticArrayDecode(benchmark::State &state) {
+    using Array = bitstream::Static::Array<Field, items>;
+    std::vector<char> data(Array::bytes_occupied + 8);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7);
+    }
+    Array array(data.data());
+    std::vector<typename Field::type> values(items);
+    for (auto _: state) {
+        for (long i = 0; i < items; ++i) {
+            values[i] = array[i];
+        }
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * items);
+    state.SetBytesProcessed(int64_t(state.iterations()) * Array::bytes_occupied);
+}
+
+template <typename Field, long items>
+static void BM_StaticArrayDecodeInto(benchmark::State &state) {
+    using Array = bitstream::Static::Array<Field, items>;
+    std::vector<char> data(Array::bytes_occupied + 8);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7);
+    }
+    Array array(data.data());
+    std::vector<typename Field::type> values(items);
+    auto previous = bitstream::machine::bulk::isa(bitstream::machine::bulk::ISA(state.range(0)));
+    for (auto _: state) {
+        array.decode_into(values.data());
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    bitstream::machine::bulk::isa(previous);
+    state.SetItemsProcessed(int64_t(state.iterations()) * items);
+    state.SetBytesProcessed(int64_t(state.iterations()) * Array::bytes_occupied);
+}
+
+template <typename Field, long items>
+static void BM_StaticArrayEncode(benchmark::State &state) {
+    using Array = bitstream::Static::Array<Field, items>;
+    std::vector<char> data(Array::bytes_occupied + 8);
+    Array array(data.data());
+    std::vector<typename Field::type> values(items);
+    for (long i = 0; i < items; ++i) {
+        values[i] = typename Field::type(i * 131 + 7);
+    }
+    auto previous = bitstream::machine::bulk::isa(bitstream::machine::bulk::ISA(state.range(0)));
+    for (auto _: state) {
+        if (state.range(1)) {
+            array.encode_from(values.data(), items);
+        } else {
+            for (long i = 0; i < items; ++i) {
+                array[i] = values[i];
+            }
+        }
+        benchmark::ClobberMemory();
+    }
+    bitstream::machine::bulk::isa(previous);
+    state.SetItemsProcessed(int64_t(state.iterations()) * items);
+    state.SetBytesProcessed(int64_t(state.iterations()) * Array::bytes_occupied);
+}
+
+#define BENCHMARK_STATIC_ARRAY(name, items, ...) \
+    BENCHMARK_TEMPLATE(BM_StaticArrayDecode, bitstream::Field<__VA_ARGS__>, items)->Name("Static::Array/decode/" name); \
+    BENCHMARK_TEMPLATE(BM_StaticArrayDecodeInto, bitstream::Field<__VA_ARGS__>, items)->Name("Static::Array/decode_into/" name) \
+        ->Arg(bitstream::machine::bulk::scalar)->Arg(bitstream::machine::bulk::sse41)->Arg(bitstream::machine::bulk::avx2); \
+    BENCHMARK_TEMPLATE(BM_StaticArrayEncode, bitstream::Field<__VA_ARGS__>, items)->Name("Static::Array/encode/" name) \
+        ->ArgNames({"isa", "bulk"})->Args({bitstream::machine::bulk::scalar, 0}) \
+        ->Args({bitstream::machine::bulk::scalar, 1})->Args({bitstream::machine::bulk::sse41, 1})->Args({bitstream::machine::bulk::avx2, 1})
+
+BENCHMARK_STATIC_ARRAY("be/u16",   1024, 16, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u32",   1024, 32, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u64",   1024, 64, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("le/u32",   1024, 32, 0, Endianness::little, unsigned);
+BENCHMARK_STATIC_ARRAY("be/u1",    1024,  1, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u2",    1024,  2, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u4",    1024,  4, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u12",   1024, 12, 0, Endianness::big,    unsigned);
+BENCHMARK_STATIC_ARRAY("be/u12/3", 1024, 12, 3, Endianness::big,    unsigned);
+
+
+// Packed items of other sizes, PDEP/PEXT kernels vs. their scalar fallback
+template <typename Field, long items>
+static void BM_SpreadArray(benchmark::State &state) {
+    using Array = bitstream::Static::Array<Field, items>;
+    std::vector<char> data(Array::bytes_occupied + 8);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7);
+    }
+    Array array(data.data());
+    std::vector<typename Field::type> values(items);
+    auto previous = bitstream::machine::bulk::bmi2(state.range(1));
+    for (auto _: state) {
+        if (state.range(0)) {
+            array.encode_from(values.data(), items);
+        } else {
+            array.decode_into(values.data());
+        }
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    bitstream::machine::bulk::bmi2(previous);
+    state.SetItemsProcessed(int64_t(state.iterations()) * items);
+    state.SetBytesProcessed(int64_t(state.iterations()) * Array::bytes_occupied);
+}
+
+#define BENCHMARK_SPREAD_ARRAY(name, items, ...) \
+    BENCHMARK_TEMPLATE(BM_SpreadArray, bitstream::Field<__VA_ARGS__>, items)->Name("Static::Array/spread/" name) \
+        ->ArgNames({"encode", "bmi2"})->Args({0, 0})->Args({0, 1})->Args({1, 0})->Args({1, 1})
+
+BENCHMARK_SPREAD_ARRAY("be/u5",    1024,  5, 0, Endianness::big,    unsigned);
+BENCHMARK_SPREAD_ARRAY("le/u7/1",  1024,  7, 1, Endianness::little, unsigned);
+BENCHMARK_SPREAD_ARRAY("be/u12",   1024, 12, 0, Endianness::big,    unsigned);
+BENCHMARK_SPREAD_ARRAY("be/u12/3", 1024, 12, 3, Endianness::big,    unsigned);
+BENCHMARK_SPREAD_ARRAY("le/u15",   1024, 15, 0, Endianness::little, unsigned);
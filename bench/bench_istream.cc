@@ -0,0 +1,144 @@
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <benchmark/benchmark.h>
+#include <bitstream/ifstream.h>
+#include <bitstream/iustream.h>
+#include <bitstream/immstream.h>
+
+
+// Large file shared by all input stream benchmarks, BITSTREAM_BENCH_FILE
+// and BITSTREAM_BENCH_FILE_SIZE (MiB) environment variables override defaults.
+struct File {
+    std::string path;
+    uint64_t size;
+
+    File() {
+        auto path = std::getenv("BITSTREAM_BENCH_FILE");
+        auto size = std::getenv("BITSTREAM_BENCH_FILE_SIZE");
+        this->path = path ? path : "/tmp/bitstream-bench-istream.data";
+        this->size = uint64_t(size ? std::atol(size) : 256) << 20;
+
+        int fd = ::open(this->path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd == -1 || ::lseek(fd, 0, SEEK_END) >= off_t(this->size)) {
+            ::close(fd);
+            return;
+        }
+        std::vector<char> chunk(1 << 20);
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            chunk[i] = char(i * 7);
+        }
+        ::ftruncate(fd, 0);
+        for (uint64_t written = 0; written < this->size; written += chunk.size()) {
+            if (::write(fd, chunk.data(), chunk.size()) != ssize_t(chunk.size())) {
+                break;
+            }
+        }
+        ::fsync(fd);
+        ::close(fd);
+    }
+
+    // Evicts the file from the page cache, so the next pass reads from the device
+    void drop_cache() const {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+
+    static const File &instance() {
+        static File file;
+        return file;
+    }
+};
+
+
+// Every byte of every record is read, whichever stream it comes from
+static uint64_t checksum(const char *data, unsigned long size) {
+    uint64_t sum = 0;
+    for (unsigned long i = 0; i + sizeof(sum) <= size; i += sizeof(sum)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        sum += word;
+    }
+    return sum;
+}
+
+template <typename Stream>
+static void parse(Stream &stream, unsigned long record) {
+    uint64_t sum = 0;
+    try {
+        for (;;) {
+            sum += checksum(stream.peak(record), record);
+            stream.get_blob(record);
+        }
+    } catch (const bitstream::Stream::EndOfStream &) {
+    }
+    benchmark::DoNotOptimize(sum);
+}
+
+static const unsigned long buffer_capacity = 64 * 1024;
+
+template <typename Stream>
+struct Make;
+
+template <>
+struct Make<bitstream::input::file::Stream> {
+    static bitstream::input::file::Stream *stream(const std::string &path) {
+        return new bitstream::input::file::Stream(path, buffer_capacity);
+    }
+};
+
+struct RingStream: bitstream::input::file::Stream {
+    RingStream(const std::string &path)
+        : bitstream::input::file::Stream(path, buffer_capacity, ring_buffer) {}
+};
+
+template <>
+struct Make<RingStream> {
+    static RingStream *stream(const std::string &path) {
+        return new RingStream(path);
+    }
+};
+
+template <>
+struct Make<bitstream::input::uring::Stream> {
+    static bitstream::input::uring::Stream *stream(const std::string &path) {
+        return new bitstream::input::uring::Stream(path, buffer_capacity, 8, 256 * 1024);
+    }
+};
+
+template <>
+struct Make<bitstream::input::mmap::Stream> {
+    static bitstream::input::mmap::Stream *stream(const std::string &path) {
+        return new bitstream::input::mmap::Stream(path);
+    }
+};
+
+
+template <typename Stream, bool cold>
+static void BM_InputStream(benchmark::State &state) {
+    const auto &file = File::instance();
+    for (auto _: state) {
+        if (cold) {
+            state.PauseTiming();
+            file.drop_cache();
+            state.ResumeTiming();
+        }
+        std::unique_ptr<Stream> stream(Make<Stream>::stream(file.path));
+        parse(*stream, state.range(0));
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * file.size);
+}
+
+#define BENCHMARK_INPUT_STREAM(Stream) \
+    BENCHMARK_TEMPLATE(BM_InputStream, Stream, true)->Name("InputStream/cold/" #Stream)->Arg(64)->Arg(4096)->Arg(buffer_capacity)->Unit(benchmark::kMillisecond)->UseRealTime(); \
+    BENCHMARK_TEMPLATE(BM_InputStream, Stream, false)->Name("InputStream/warm/" #Stream)->Arg(64)->Arg(4096)->Arg(buffer_capacity)->Unit(benchmark::kMillisecond)->UseRealTime()
+
+BENCHMARK_INPUT_STREAM(bitstream::input::file::Stream);
+BENCHMARK_INPUT_STREAM(RingStream);
+BENCHMARK_INPUT_STREAM(bitstream::input::uring::Stream);
+BENCHMARK_INPUT_STREAM(bitstream::input::mmap::Stream);
@@ -0,0 +1,246 @@
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <bitstream/field.h>
+#include <bitstream/array.h>
+#include <bitstream/header.h>
+#include <bitstream/parser.h>
+#include <bitstream/imstream.h>
+#include <bitstream/omheader.h>
+#include <bitstream/omftag.h>
+#include <bitstream/obstream.h>
+#include <bitstream/opstream.h>
+#include <bitstream/ojstream.h>
+#include <bitstream/machine/bulk.h>
+
+
+namespace be = bitstream::be;
+namespace meta = bitstream::output::meta;
+
+
+// Full box alike record, each printed field goes through the meta field stream
+struct Box: bitstream::Header, meta::Header {
+    static const long bytes = 28;
+
+    be::UInt32<0> size;
+    be::UInt32<32> type;
+    be::UInt8<64> version;
+    be::UInt<24, 72> flags;
+    be::UInt64<96> time;
+    be::UInt16<160>::Static::Array<4> entries;
+
+    Box(const char *data)
+        : size(data), type(data), version(data), flags(data), time(data), entries(data) {}
+
+    void output_header(meta::header::Stream &stream) const override {
+        meta::Stream::Tag tag;
+        tag.name = "box";
+        tag.size = 8 * bytes;
+        stream.header(tag, size.buffer());
+    }
+
+    void output_fields(meta::field::Stream &stream) const override {
+        meta::field::tag::Stream fields(stream);
+        fields.tag(size) << "size";
+        fields.tag(type) << "type" << meta::field::tag::Format("fourcc");
+        fields.tag(version) << "version";
+        fields.tag(flags) << "flags";
+        fields.tag(time) << "creation_time";
+        fields.tag(entries) << "entries";
+    }
+};
+
+// Same box, tags defined once per call site
+struct StaticBox: Box {
+    using Box::Box;
+
+    void output_header(meta::header::Stream &stream) const override {
+        static const meta::Stream::Tag tag = [] {
+            meta::Stream::Tag tag;
+            tag.name = "box";
+            tag.size = 8 * bytes;
+            return tag;
+        }();
+        stream.header(tag, size.buffer());
+    }
+
+    void output_fields(meta::field::Stream &stream) const override {
+        meta::field::tag::Stream fields(stream);
+        fields.tag(size, [](auto &tag) { tag << "size"; });
+        fields.tag(type, [](auto &tag) { tag << "type" << meta::field::tag::Format("fourcc"); });
+        fields.tag(version, [](auto &tag) { tag << "version"; });
+        fields.tag(flags, [](auto &tag) { tag << "flags"; });
+        fields.tag(time, [](auto &tag) { tag << "creation_time"; });
+        fields.tag(entries, [](auto &tag) { tag << "entries"; });
+    }
+};
+
+// Every 16 boxes are children of a parent one
+template <typename Box>
+struct BoxParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+
+    void parse(bitstream::Remainder remainder = bitstream::Remainder(), bool = false) override {
+        try {
+            for (;;) {
+                Box parent(stream.peak(Box::bytes));
+                Event::Header{*this, parent};
+                stream.get_blob(Box::bytes);
+                Event::Payload::Boundary::Scope scope(*this, parent, remainder);
+                for (int i = 0; i < 16; ++i) {
+                    Box child(stream.peak(Box::bytes));
+                    Event::Header{*this, child};
+                    stream.get_blob(Box::bytes);
+                }
+            }
+        } catch (const bitstream::Stream::EndOfStream &) {
+        }
+    }
+};
+
+
+template <typename Box>
+static void BM_PrintStream(benchmark::State &state) {
+    const long boxes = 17 * 1024;
+    std::vector<char> data(boxes * Box::bytes);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7);
+    }
+    std::ofstream null("/dev/null");
+    for (auto _: state) {
+        bitstream::input::memory::Stream stream(data.data(), data.size());
+        bitstream::output::print::Stream print(null, null);
+        BoxParser<Box> parser(stream, print);
+        parser.parse();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * boxes);
+}
+
+BENCHMARK_TEMPLATE(BM_PrintStream, Box)->Name("print::Stream/boxes")->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_PrintStream, StaticBox)->Name("print::Stream/boxes/static_tags")->Unit(benchmark::kMillisecond);
+
+// Same boxes as NDJSON lines
+static void BM_JsonStream(benchmark::State &state) {
+    const long boxes = 17 * 1024;
+    std::vector<char> data(boxes * StaticBox::bytes);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7);
+    }
+    std::ofstream null("/dev/null");
+    for (auto _: state) {
+        bitstream::input::memory::Stream stream(data.data(), data.size());
+        bitstream::output::json::Stream json(null);
+        BoxParser<StaticBox> parser(stream, json);
+        parser.parse();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * boxes);
+}
+
+BENCHMARK(BM_JsonStream)->Name("json::Stream/boxes/static_tags")->Unit(benchmark::kMillisecond);
+
+// Escaping a mostly plain string, 64 KiB with a quote every 4 KiB
+static void BM_JsonQuote(benchmark::State &state) {
+    std::string string(1 << 16, 'a');
+    for (unsigned long i = 4095; i < string.size(); i += 4096) {
+        string[i] = '"';
+    }
+    std::ofstream null("/dev/null");
+    bitstream::output::buffered::Stream out(null);
+    auto previous = bitstream::machine::bulk::isa(bitstream::machine::bulk::ISA(state.range(0)));
+    for (auto _: state) {
+        bitstream::output::json::quote(out, string);
+        out.commit();
+    }
+    bitstream::machine::bulk::isa(previous);
+    state.SetBytesProcessed(int64_t(state.iterations()) * string.size());
+}
+
+BENCHMARK(BM_JsonQuote)->Name("json::quote")->Arg(bitstream::machine::bulk::scalar)
+    ->Arg(bitstream::machine::bulk::sse41)->Arg(bitstream::machine::bulk::avx2);
+
+
+// Sample size box alike: a long table printed with ellipses, so only its ends are shown
+template <bool materialized>
+struct Table: bitstream::Header, meta::Header {
+    static const long entries = 1 << 16;
+    bitstream::Array<be::UInt32<>> sizes;
+
+    Table(const char *data) : sizes(data, entries) {}
+
+    void output_header(meta::header::Stream &stream) const override {
+        meta::Stream::Tag tag;
+        tag.name = "stsz";
+        tag.size = 32 * entries;
+        stream.header(tag, sizes.buffer());
+    }
+
+    void output_fields(meta::field::Stream &stream) const override {
+        meta::field::tag::Stream fields(stream);
+        if (materialized) {
+            fields.tag(typename decltype(sizes)::Vector(sizes)) << "sizes";
+        } else {
+            fields.tag(sizes) << "sizes";
+        }
+    }
+};
+
+template <typename Table>
+struct TableParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+    const char *data;
+
+    void parse(bitstream::Remainder = bitstream::Remainder(), bool = false) override {
+        for (int i = 0; i < 16; ++i) {
+            Table table(data);
+            Event::Header{*this, table};
+        }
+    }
+};
+
+template <bool materialized>
+static void BM_PrintTable(benchmark::State &state) {
+    std::vector<char> data(4 * Table<materialized>::entries, 7);
+    std::ofstream null("/dev/null");
+    bitstream::input::memory::Stream stream(data.data(), data.size());
+    bitstream::output::print::Stream print(null, null);
+    print.array_ellipses = true;
+    TableParser<Table<materialized>> parser(stream, print);
+    parser.data = data.data();
+    for (auto _: state) {
+        parser.parse();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 16);
+}
+
+BENCHMARK_TEMPLATE(BM_PrintTable, true)->Name("print::Stream/table/vector");
+BENCHMARK_TEMPLATE(BM_PrintTable, false)->Name("print::Stream/table/view");
+
+
+// Field lines alone: what the formatters used to do with iostreams vs the buffered stream
+static void BM_IOStreamLines(benchmark::State &state) {
+    std::ofstream null("/dev/null");
+    for (auto _: state) {
+        for (long i = 0; i < 1024; ++i) {
+            null << "|  |      " << std::setw(10) << std::left << "uint32";
+            null << " " << std::setw(20) << std::left << "creation_time" << ": " << i * 7919 << std::endl;
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1024);
+}
+
+static void BM_BufferedLines(benchmark::State &state) {
+    std::ofstream null("/dev/null");
+    bitstream::output::buffered::Stream out(null);
+    for (auto _: state) {
+        for (long i = 0; i < 1024; ++i) {
+            out << "|  |      " << bitstream::output::buffered::width(10) << "uint32";
+            out << " " << bitstream::output::buffered::width(20) << "creation_time" << ": " << i * 7919 << '\n';
+        }
+        out.commit();
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * 1024);
+}
+
+BENCHMARK(BM_IOStreamLines)->Name("lines/iostream");
+BENCHMARK(BM_BufferedLines)->Name("lines/buffered");
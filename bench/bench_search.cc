@@ -0,0 +1,76 @@
+#include <random>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include <bitstream/array.h>
+#include <bitstream/search.h>
+
+
+using Table = bitstream::Array<bitstream::be::UInt32<>>;
+
+// Sorted big endian table of state.range(0) entries, and random queries over it
+struct Sorted {
+    std::vector<char> data;
+    Table table;
+    std::vector<uint32_t> queries;
+
+    Sorted(long items) : data(4 * items), table(data.data(), items) {
+        std::mt19937 random(7);
+        std::vector<uint32_t> values(items);
+        uint32_t value = 0;
+        for (auto &v: values) {
+            v = value += random() % 16;
+        }
+        table = values;
+        for (int i = 0; i < 4096; ++i) {
+            queries.push_back(random() % (value + 1));
+        }
+    }
+};
+
+static void BM_SearchMaterialized(benchmark::State &state) {
+    Sorted sorted(state.range(0));
+    for (auto _: state) {
+        Table::Vector vector = sorted.table;
+        for (auto query: sorted.queries) {
+            benchmark::DoNotOptimize(std::lower_bound(vector.begin(), vector.end(), query));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * sorted.queries.size());
+}
+
+static void BM_SearchStd(benchmark::State &state) {
+    Sorted sorted(state.range(0));
+    auto range = sorted.table.range();
+    for (auto _: state) {
+        for (auto query: sorted.queries) {
+            benchmark::DoNotOptimize(std::lower_bound(range.begin(), range.end(), query));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * sorted.queries.size());
+}
+
+static void BM_SearchBranchFree(benchmark::State &state) {
+    Sorted sorted(state.range(0));
+    for (auto _: state) {
+        for (auto query: sorted.queries) {
+            benchmark::DoNotOptimize(bitstream::search::lower_bound(sorted.table, query));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * sorted.queries.size());
+}
+
+static void BM_SearchEytzinger(benchmark::State &state) {
+    Sorted sorted(state.range(0));
+    auto index = bitstream::search::eytzinger(sorted.table);
+    for (auto _: state) {
+        for (auto query: sorted.queries) {
+            benchmark::DoNotOptimize(index.lower_bound(query));
+        }
+    }
+    state.SetItemsProcessed(int64_t(state.iterations()) * sorted.queries.size());
+}
+
+BENCHMARK(BM_SearchMaterialized)->Name("Search/materialized")->Arg(1 << 16);
+BENCHMARK(BM_SearchStd)->Name("Search/std::lower_bound")->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(BM_SearchBranchFree)->Name("Search/lower_bound")->Arg(1 << 16)->Arg(1 << 22);
+BENCHMARK(BM_SearchEytzinger)->Name("Search/eytzinger")->Arg(1 << 16)->Arg(1 << 22);
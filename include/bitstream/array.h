@@ -2,12 +2,28 @@
 #define __BITSTREAM_ARRAY_H__
 
 #include <cassert>
+#include <iterator>
 #include <vector>
 #include <bitstream/field.h>
+#include <bitstream/machine/bulk.h>
 
 
 namespace bitstream {
 
+
+// Pair of iterators usable with range based for and std algorithms
+template <typename Iterator>
+struct Range {
+    Iterator begin_, end_;
+
+    Iterator begin() const { return begin_; }
+    Iterator end() const { return end_; }
+    unsigned long size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+    typename Iterator::reference operator [] (long n) const { return begin_[n]; }
+};
+
+
 namespace Static {
 
 
@@ -25,8 +41,10 @@ struct Array<bitstream::Field<size, offset, endianness, signedness>, items_>: Fo
 
     template <bool aligned = offset % 8 == 0 && size % 8 == 0, typename U = void>
     struct Item {
+        using Codec = machine::Runtime<size, endianness>;
+
         char *buffer;
-        long offset_;
+        long offset_;   // Bits into the buffer, within [0, 8)
         Item(char *buffer, long index)
             : buffer(buffer + (offset + index * size) / 8)
             , offset_(        (offset + index * size) % 8) {
@@ -34,34 +52,22 @@ struct Array<bitstream::Field<size, offset, endianness, signedness>, items_>: Fo
         }
 
         operator Type() const {
-            switch (offset_) {
-            case 0: return Field<0>{buffer}; break;
-            case 1: return Field<1>{buffer}; break;
-            case 2: return Field<2>{buffer}; break;
-            case 3: return Field<3>{buffer}; break;
-            case 4: return Field<4>{buffer}; break;
-            case 5: return Field<5>{buffer}; break;
-            case 6: return Field<6>{buffer}; break;
-            case 7: return Field<7>{buffer}; break;
-            default:
-                assert(offset_ < 8);
-                return Type(0);
-            }
+            return Field<>::Sign::template Extension<>::cast(Codec::get(buffer, offset_));
         }
 
         Item &operator = (Type value) {
-            switch (offset_) {
-            case 0: Field<0>{buffer} = value; break;
-            case 1: Field<1>{buffer} = value; break;
-            case 2: Field<2>{buffer} = value; break;
-            case 3: Field<3>{buffer} = value; break;
-            case 4: Field<4>{buffer} = value; break;
-            case 5: Field<5>{buffer} = value; break;
-            case 6: Field<6>{buffer} = value; break;
-            case 7: Field<7>{buffer} = value; break;
-            }
+            Codec::set(buffer, offset_, value);
             return *this;
         }
+
+        void advance(long count = 1) {
+            offset_ += count * size;
+            buffer += offset_ >> 3;     // Floors negative offsets as well
+            offset_ &= 7;
+        }
+
+        bool operator == (const Item &item) const { return buffer == item.buffer && offset_ == item.offset_; }
+        long operator - (const Item &item) const { return ((buffer - item.buffer) * 8 + offset_ - item.offset_) / size; }
     };
 
     template <typename U>
@@ -79,8 +85,79 @@ struct Array<bitstream::Field<size, offset, endianness, signedness>, items_>: Fo
             Field<0>{buffer} = value;
             return *this;
         }
+
+        void advance(long count = 1) {
+            buffer += count * (size / 8);
+        }
+
+        bool operator == (const Item &item) const { return buffer == item.buffer; }
+        long operator - (const Item &item) const { return (buffer - item.buffer) / (size / 8); }
     };
 
+    // Random access iterators decoding lazily, the cursor moves by the item size instead of being
+    // recomputed from an index. With prefetch set, each step hints the cache prefetch bytes ahead.
+    template <typename Reference, long prefetch = 0>
+    struct Iterator {
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Type;
+        using difference_type = long;
+        using reference = Reference;
+        using pointer = void;
+
+        Item<> item;
+
+        Iterator(const Item<> &item) : item(item) {}
+        Iterator(const Item<> &item, long count) : item(item) { this->item.advance(count); }
+
+        Reference operator * () const { return item; }
+        Reference operator [] (long n) const { return *(*this + n); }
+
+        Iterator &operator ++ () { return *this += 1; }
+        Iterator &operator -- () { return *this -= 1; }
+        Iterator operator ++ (int) { auto i = *this; *this += 1; return i; }
+        Iterator operator -- (int) { auto i = *this; *this -= 1; return i; }
+
+        Iterator &operator += (long n) {
+            item.advance(n);
+            if (prefetch) {
+                __builtin_prefetch(item.buffer + prefetch);
+            }
+            return *this;
+        }
+        Iterator &operator -= (long n) { item.advance(-n); return *this; }
+        Iterator operator + (long n) const { return Iterator(item, n); }
+        Iterator operator - (long n) const { return Iterator(item, -n); }
+        friend Iterator operator + (long n, const Iterator &i) { return i + n; }
+        long operator - (const Iterator &i) const { return item - i.item; }
+
+        bool operator == (const Iterator &i) const { return item == i.item; }
+        bool operator != (const Iterator &i) const { return !(item == i.item); }
+        bool operator <  (const Iterator &i) const { return *this - i <  0; }
+        bool operator >  (const Iterator &i) const { return *this - i >  0; }
+        bool operator <= (const Iterator &i) const { return *this - i <= 0; }
+        bool operator >= (const Iterator &i) const { return *this - i >= 0; }
+    };
+
+    using iterator = Iterator<Item<>>;
+    using const_iterator = Iterator<Type>;
+    using const_range = bitstream::Range<const_iterator>;
+
+    template <long distance>
+    using prefetched_range = bitstream::Range<Iterator<Type, distance>>;
+
+    iterator begin() { return iterator((*this)[0]); }
+    iterator end() { return iterator((*this)[0], items); }
+    const_iterator begin() const { return const_iterator((*this)[0]); }
+    const_iterator end() const { return const_iterator((*this)[0], items); }
+
+    const_range range() const { return const_range{begin(), end()}; }
+
+    // For long sequential scans, distance is in bytes
+    template <long distance = 512>
+    prefetched_range<distance> prefetched() const {
+        return prefetched_range<distance>{{(*this)[0]}, {(*this)[0], long(items)}};
+    }
+
     Item<> operator[](long index) {
         return Item<>(this->buffer(), index);
     }
@@ -102,12 +179,23 @@ struct Array<bitstream::Field<size, offset, endianness, signedness>, items_>: Fo
         return this->buffer();
     }
 
+    // Decodes first n items, with SIMD kernels where the layout has one
+    void decode_into(Type *out, unsigned long n) const {
+        Codec<>::get(*this, out, n);
+    }
+
+    // Encodes first n items, likewise
+    void encode_from(const Type *in, unsigned long n) {
+        Codec<>::set(*this, in, n);
+    }
+
+    void decode_into(Type *out) const {
+        decode_into(out, items);
+    }
+
     operator typename Array::Vector () const {
-        typename Array::Vector v;
-        v.reserve(items);
-        for (auto i = 0; i < items; ++i) {
-            v.push_back((*this)[i]);
-        }
+        typename Array::Vector v(items);
+        decode_into(v.data(), items);
         return v;
     }
 
@@ -135,6 +223,39 @@ struct Array<bitstream::Field<size, offset, endianness, signedness>, items_>: Fo
         return *this;
     }
 
+    auto &operator = (const Vector &v) {
+        assert(v.size() == items);
+        encode_from(v.data(), v.size());
+        return *this;
+    }
+
+protected:
+    using Bulk = machine::bulk::Codec<size, offset, endianness, signedness>;
+
+    template <bool kernel = Bulk::kernel, typename U = void>
+    struct Codec {
+        static void get(const Array &array, Type *out, unsigned long n) {
+            for (unsigned long i = 0; i < n; ++i) {
+                out[i] = array[i];
+            }
+        }
+        static void set(Array &array, const Type *in, unsigned long n) {
+            for (unsigned long i = 0; i < n; ++i) {
+                array[i] = in[i];
+            }
+        }
+    };
+
+    template <typename U>
+    struct Codec<true, U> {
+        static void get(const Array &array, Type *out, unsigned long n) {
+            Bulk::get(array.buffer(), out, n);
+        }
+        static void set(Array &array, const Type *in, unsigned long n) {
+            Bulk::set(array.buffer(), in, n);
+        }
+    };
+
 private:
     template <long index, bool exceeds = (index != 0 && index >= items)>
     struct AssertRange {};
@@ -156,12 +277,33 @@ struct Array<Field<size, offset, endianness, signedness>>: Static::Array<Field<s
     Array(const char *buffer, unsigned long items = 0)
         : Static::Array<Field<size, offset, endianness, signedness>, 0>(buffer), items(items) {}
 
+    using Static::Array<Field<size, offset, endianness, signedness>, 0>::decode_into;
+    using typename Static::Array<Field<size, offset, endianness, signedness>, 0>::iterator;
+    using typename Static::Array<Field<size, offset, endianness, signedness>, 0>::const_iterator;
+    using typename Static::Array<Field<size, offset, endianness, signedness>, 0>::const_range;
+
+    template <long distance>
+    using prefetched_range = typename Static::Array<Field<size, offset, endianness, signedness>, 0>::template prefetched_range<distance>;
+
+    iterator begin() { return iterator((*this)[0]); }
+    iterator end() { return iterator((*this)[0], items); }
+    const_iterator begin() const { return const_iterator((*this)[0]); }
+    const_iterator end() const { return const_iterator((*this)[0], items); }
+
+    const_range range() const { return const_range{begin(), end()}; }
+
+    template <long distance = 512>
+    prefetched_range<distance> prefetched() const {
+        return prefetched_range<distance>{{(*this)[0]}, {(*this)[0], long(items)}};
+    }
+
+    void decode_into(Type *out) const {
+        decode_into(out, items);
+    }
+
     operator typename Array::Vector () const {
-        typename Array::Vector v;
-        v.reserve(items);
-        for (auto i = 0; i < items; ++i) {
-            v.push_back((*this)[i]);
-        }
+        typename Array::Vector v(items);
+        decode_into(v.data(), items);
         return v;
     }
 
@@ -188,6 +330,12 @@ struct Array<Field<size, offset, endianness, signedness>>: Static::Array<Field<s
         }
         return *this;
     }
+
+    auto &operator = (const typename Array::Vector &v) {
+        assert(v.size() == items);
+        this->encode_from(v.data(), v.size());
+        return *this;
+    }
 };
 
 
@@ -1,15 +1,73 @@
 #ifndef __BITSTREAM_BLOB_H__
 #define __BITSTREAM_BLOB_H__
 
+#include <stdint.h>
+#include <vector>
+
 
 namespace bitstream {
 
 struct Blob {
+    struct Chunk;
+    struct Chunks;
+
     virtual ~Blob() {}
     virtual unsigned long size() const = 0;
+
+    // The entire blob if it's resident in memory, nullptr otherwise.
+    // Like the blob itself it's valid until its stream is used again.
+    virtual const char *data() const { return nullptr; }
+
+    // Copies up to size bytes from the offset within the blob, returns number of bytes copied
+    virtual unsigned long read_into(char *buffer, unsigned long size, uint64_t offset = 0) const;
+
+    // Writes the entire blob to the file descriptor, returns number of bytes written
+    virtual uint64_t read_into(int fd) const;
+
+    // Resident blob is a single chunk, otherwise it's read chunk by chunk into a buffer
+    Chunks chunks(unsigned long size = 64 * 1024) const;
+};
+
+
+struct Blob::Chunk {
+    const char *data;
+    unsigned long size;
+};
+
+
+struct Blob::Chunks {
+
+    struct iterator {
+        const Chunk &operator * () const { return chunk; }
+        const Chunk *operator -> () const { return &chunk; }
+        iterator &operator ++ () { offset += chunk.size; chunks.load(*this); return *this; }
+        bool operator == (const iterator &it) const { return offset == it.offset; }
+        bool operator != (const iterator &it) const { return offset != it.offset; }
+
+        Chunks &chunks;
+        uint64_t offset;
+        Chunk chunk;
+    };
+
+    Chunks(const Blob &blob, unsigned long size) : blob(blob), size(size) {}
+
+    iterator begin() { iterator it{*this, 0, {}}; load(it); return it; }
+    iterator end() { return iterator{*this, blob.size(), {}}; }
+
+private:
+    void load(iterator &it);
+
+    const Blob &blob;
+    unsigned long size;
+    std::vector<char> buffer;
 };
 
+
+inline Blob::Chunks Blob::chunks(unsigned long size) const {
+    return Chunks(*this, size);
+}
+
+
 } // namespace bitstream
 
 #endif // __BITSTREAM_BLOB_H__
-
@@ -0,0 +1,64 @@
+#ifndef __BITSTREAM_DRIVER_H__
+#define __BITSTREAM_DRIVER_H__
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bitstream/parser.h>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+// Parses many files concurrently, one parser and observer per file
+struct Driver {
+
+    using Duration = std::chrono::steady_clock::duration;
+
+    using StreamFactory   = std::function<std::unique_ptr<bitstream::Stream> (const std::string &path)>;
+    using ObserverFactory = std::function<std::unique_ptr<Parser::Observer> (const std::string &path)>;
+    using ParserFactory   = std::function<std::unique_ptr<Parser> (bitstream::Stream &, Parser::Observer &)>;
+
+    struct Result {
+        std::string path;
+        uint64_t bytes = 0;                         // Stream offset parsing ended at
+        Duration duration = Duration::zero();
+        std::exception_ptr exception;               // Set if parsing (or opening) failed
+        std::unique_ptr<Parser::Observer> observer; // Whatever it has collected
+    };
+
+    struct Summary {
+        std::vector<Result> results;                // In the order of paths
+        uint64_t bytes = 0;
+        unsigned long failed = 0;
+        Duration elapsed = Duration::zero();        // Wall clock time
+
+        double throughput() const;                  // Bytes per second
+        double files_per_second() const;
+    };
+
+    Driver(ParserFactory parser, ObserverFactory observer,
+           unsigned threads = std::thread::hardware_concurrency(), unsigned long queue = 64);
+
+    Summary run(const std::vector<std::string> &paths) const;
+
+    StreamFactory stream;   // input::file::Stream by default
+    ParserFactory parser;
+    ObserverFactory observer;
+    unsigned threads;
+    unsigned long queue;    // Most files waiting for a worker
+
+private:
+    void parse(const std::string &path, Result &result) const;
+};
+
+
+}} // namespace bitstream::parallel
+
+
+#endif // __BITSTREAM_DRIVER_H__
@@ -14,8 +14,23 @@ namespace file {
 
 struct Stream: bitstream::Stream {
 
-    Stream(const std::string &path, unsigned long capacity = 4 * 512)
-        : file(path), buffer(capacity) {}
+    enum Options {
+        direct_io   = 1 << 0,   // Bypass the page cache (O_DIRECT) if the file system supports it
+        ring_buffer = 1 << 1,   // Double mapped buffer, leftovers are never moved on refill
+    };
+
+    // If max_capacity exceeds capacity the buffer grows geometrically up to it whenever
+    // peak() asks for more than fits, otherwise such a peak() throws
+    Stream(const std::string &path, unsigned long capacity = 4 * 512, unsigned options = 0, unsigned long max_capacity = 0)
+        : file(path, options & direct_io), buffer(capacity, file.block_size, options & ring_buffer, file.direct, max_capacity) {
+        blob.file = &file;
+    }
+
+    struct Statistics {
+        unsigned long largest_peak = 0;     // Largest size ever requested by peak()
+        unsigned long high_water_mark = 0;  // Most bytes ever held by the buffer
+        unsigned long reallocations = 0;    // How many times the buffer has grown
+    };
 
     virtual uint64_t offset() const { return file.offset; }
 
@@ -23,27 +38,55 @@ struct Stream: bitstream::Stream {
     virtual Blob &peak_blob(unsigned long size);
     virtual Blob &get_blob(unsigned long size);
 
-private:
-    struct fstream: std::ifstream {
+    bool direct() const { return file.direct; }
+    bool ring() const { return buffer.ring; }
+    unsigned long alignment() const { return buffer.block.size; }  // Capacity is rounded up to it
+    unsigned long capacity() const { return buffer.size; }
+    const Statistics &statistics() const { return buffer.statistics; }
+
+protected:
+    // Fills data with up to size bytes from the absolute offset, returns number of bytes read
+    virtual unsigned long read(char *data, uint64_t offset, unsigned long size) {
+        return file.read(data, offset, size);
+    }
+
+    // Maps size bytes (multiple of the page size) twice back to back, release with munmap(begin, 2 * size)
+    static char *mirrored(unsigned long size);
 
-        fstream(const std::string &path);
+    struct fstream {
+
+        fstream(const std::string &path, bool direct);
+        ~fstream();
         unsigned long read(char *data, uint64_t offset, unsigned long size);
+        unsigned long copy(char *data, uint64_t offset, unsigned long size) const;   // No layout nor alignment requirements
 
         std::string path;           // Path of the file from which data is read
         uint64_t offset = 0;        // Absolute offset in the stream from wich peak/read returns data
+        int fd;
+        bool direct;                // Reads have to be aligned to block_size
+        unsigned long block_size;   // Optimal (or required if direct) IO alignment
     } file;
 
+private:
     struct Buffer {
 
-        void defragment();
+        void defragment(unsigned long alignment = 0);
         unsigned long can_read(unsigned long size);
-        unsigned long capacity() { return size - data.size; }
+        unsigned long capacity() const;
 
-        Buffer(unsigned long size);
+        Buffer(unsigned long size, unsigned long block_size, bool ring, bool aligned, unsigned long limit);
         ~Buffer();
 
+        bool ring;      // [begin + size, begin + 2 * size) mirrors [begin, begin + size)
+        bool aligned;   // Reads must end on block boundary
+        unsigned long limit;    // Size up to which the buffer may grow
+        Statistics statistics;
+
+        char *allocate(unsigned long size) const;
+        void release(char *begin, unsigned long size) const;
+        void grow(unsigned long size);
+
         struct Block {
-            Block();
             unsigned long size;
         } block;
 
@@ -64,13 +107,23 @@ private:
 
     } buffer;
 
+protected:
     struct Blob_: bitstream::Blob {
+        const fstream *file;
         uint64_t _offset = 0;        // Absolute offset in the stream
         unsigned long _size;
+        const char *_data = nullptr; // Set if the entire blob is in the buffer
 
         virtual unsigned long size() const {
             return _size;
         }
+
+        virtual const char *data() const {
+            return _data;
+        }
+
+        virtual unsigned long read_into(char *buffer, unsigned long size, uint64_t offset = 0) const;
+        virtual uint64_t read_into(int fd) const;
     } blob;
 };
 
@@ -0,0 +1,31 @@
+#ifndef __BITSTREAM_IMMSTREAM_H__
+#define __BITSTREAM_IMMSTREAM_H__
+
+#include <string>
+#include <bitstream/imstream.h>
+
+
+namespace bitstream {
+namespace input {
+namespace mmap {
+
+
+// Memory stream over a read-only mapping of the entire file
+struct Stream: memory::Stream {
+
+    enum Access {
+        normal,
+        sequential,     // Aggressive read-ahead, pages behind may be dropped early
+        random,         // No read-ahead
+    };
+
+    Stream(const std::string &path, Access access = sequential);
+    ~Stream();
+
+    void advise(Access access);
+};
+
+}}} // namespace bitstream::input::mmap
+
+
+#endif // __BITSTREAM_IMMSTREAM_H__
@@ -0,0 +1,91 @@
+#ifndef __BITSTREAM_IMSTREAM_H__
+#define __BITSTREAM_IMSTREAM_H__
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <bitstream/stream.h>
+#include <bitstream/blob.h>
+
+
+namespace bitstream {
+namespace input {
+namespace memory {
+
+
+struct Slice;
+
+
+// Stream over a caller owned memory which has to outlive it
+struct Stream: bitstream::Stream {
+
+    struct Blob: bitstream::Blob {
+        using bitstream::Blob::read_into;
+
+        virtual unsigned long size() const { return _size; }
+        virtual const char *data() const { return _resident == _size ? _data : nullptr; }  // Points into the stream's memory
+        virtual unsigned long read_into(char *buffer, unsigned long size, uint64_t offset = 0) const;
+
+        const char *_data = nullptr;
+        unsigned long _size = 0;
+        unsigned long _resident = 0;    // Bytes within the stream's memory
+    };
+
+    Stream(const char *data, uint64_t size, const std::string &name = "memory")
+        : name(name), begin_(data), size_(size) {}
+
+    virtual uint64_t offset() const { return offset_; }
+
+    virtual const char *peak(unsigned long size);
+    virtual Blob &peak_blob(unsigned long size);
+    virtual Blob &get_blob(unsigned long size);
+
+    const char *begin() const { return begin_; }
+    uint64_t size() const { return size_; }
+
+protected:
+    Stream(const std::string &name) : name(name) {}
+
+    std::string name;               // Used in error messages
+    const char *begin_ = nullptr;
+    uint64_t size_ = 0;
+    uint64_t offset_ = 0;           // Absolute offset in the stream from wich peak returns data
+
+private:
+    friend struct Slice;
+    Stream(const Stream &) = delete;
+    Stream &operator = (const Stream &) = delete;
+
+    Blob blob;
+};
+
+
+// Part [offset, offset + size) of another memory stream's data, offsets stay absolute
+struct Slice: Stream {
+    Slice(const Stream &stream, uint64_t offset, uint64_t size)
+        : Stream(stream.begin(), std::min(offset + size, stream.size()), stream.name) {
+        offset_ = offset;
+    }
+};
+
+
+namespace owning {
+
+struct Storage {
+    std::vector<char> storage;
+};
+
+// Stream which keeps the data it's parsing
+struct Stream: private Storage, memory::Stream {
+    Stream(std::vector<char> &&data, const std::string &name = "memory")
+        : Storage{std::move(data)}, memory::Stream(storage.data(), storage.size(), name) {}
+};
+
+} // namespace owning
+
+
+}}} // namespace bitstream::input::memory
+
+
+#endif // __BITSTREAM_IMSTREAM_H__
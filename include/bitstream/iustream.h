@@ -0,0 +1,39 @@
+#ifndef __BITSTREAM_IUSTREAM_H__
+#define __BITSTREAM_IUSTREAM_H__
+
+#include <memory>
+#include <bitstream/ifstream.h>
+
+
+namespace bitstream {
+namespace input {
+namespace uring {
+
+
+// File stream which keeps `depth` chunk sized reads in flight ahead of the
+// current offset (io_uring), so that the next window is usually resident by
+// the time peak() needs it. Chunks are read into slots laid out back to back
+// in a mirrored mapping and peak() returns them in place, so peaks of up to
+// capacity bytes never copy. When io_uring is unavailable it falls back to
+// synchronous preads with kernel read-ahead hints.
+struct Stream: input::file::Stream {
+
+    Stream(const std::string &path, unsigned long capacity = 4 * 512,
+           unsigned long depth = 4, unsigned long chunk = 64 * 1024);
+    ~Stream();
+
+    bool asynchronous() const;  // false if synchronous fallback is used
+
+    virtual const char *peak(unsigned long size);
+    virtual Blob &peak_blob(unsigned long size);
+    virtual Blob &get_blob(unsigned long size);
+
+private:
+    struct ReadAhead;
+    std::unique_ptr<ReadAhead> ahead;
+};
+
+}}} // namespace bitstream::input::uring
+
+
+#endif // __BITSTREAM_IUSTREAM_H__
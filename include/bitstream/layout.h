@@ -0,0 +1,82 @@
+#ifndef __BITSTREAM_LAYOUT_H__
+#define __BITSTREAM_LAYOUT_H__
+
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <bitstream/field.h>
+
+
+namespace bitstream {
+
+
+// Fields of one header (same buffer, own bit offsets) decoded together: the
+// bytes they jointly occupy are loaded and flipped once as a single word, then
+// every field is shifted and masked out of it. The fields must share
+// endianness and together fit into 64 bits, e.g. version and flags of a full box:
+//
+//     auto [version, flags] = Layout<be::UInt8<0>, be::UInt<24, 8>>::get(buffer);
+//
+template <typename... Fields>
+struct Layout {
+    static_assert(sizeof...(Fields) > 0, "Layout has to have at least one field");
+
+    template <long i>
+    using Field = std::tuple_element_t<i, std::tuple<Fields...>>;
+
+    static const long first = std::min({long(Fields::offset / 8)...});     // Byte
+    static const long last  = std::max({long(Fields::bytes_occupied)...}); // Byte, past the end
+    static const long bytes = last - first;
+    static const Endianness endianness = Field<0>::endianness;
+
+    static_assert(((Fields::endianness == endianness) && ...), "Layout fields have to share endianness");
+    static_assert(bytes <= 8, "Layout fields have to fit into 64 bits");
+
+    using word_t = typename machine::integral::Type<8 * bytes, unsigned>::type_t;
+    static const long word_bits = 8 * sizeof(word_t);
+    static const bool do_flip = machine::endianness != endianness;
+
+    // Whole word is flipped, so that it's a plain byte swap
+    static word_t word(const char *buffer) {
+        return machine::Flippable<do_flip>::template flip<sizeof(word_t)>(
+            machine::Memory<first>::template get<word_t>(buffer));
+    }
+
+    template <typename Field>
+    struct Extract {
+        static const long rbits = Field::offset - 8 * first;  // From the beginning of the word
+        static const long lsb = endianness == Endianness::big ? word_bits - rbits - Field::size : rbits;
+        static const word_t mask = word_t(~word_t(0)) >> (word_bits - Field::size);
+
+        static typename Field::type from(word_t word) {
+            return static_cast<typename Field::type>(
+                Field::Sign::template Extension<>::cast(
+                typename Field::utype(machine::shift<lsb>::right(word) & mask)));
+        }
+    };
+
+    // Loaded word, fields are extracted from it on demand
+    struct Loaded {
+        word_t word;
+
+        template <long i>
+        typename Field<i>::type get() const {
+            return Extract<Field<i>>::from(word);
+        }
+    };
+
+    static Loaded load(const char *buffer) {
+        return Loaded{word(buffer)};
+    }
+
+    static std::tuple<typename Fields::type...> get(const char *buffer) {
+        word_t word = Layout::word(buffer);
+        return std::tuple<typename Fields::type...>(Extract<Fields>::from(word)...);
+    }
+};
+
+
+} // namespace bitstream
+
+
+#endif // __BITSTREAM_LAYOUT_H__
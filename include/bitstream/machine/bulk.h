@@ -0,0 +1,143 @@
+#ifndef __BITSTREAM_MACHINE_BULK_H__
+#define __BITSTREAM_MACHINE_BULK_H__
+
+#include <stdint.h>
+#include <cstring>
+#include <type_traits>
+#include <bitstream/machine.h>
+
+
+namespace bitstream {
+namespace machine {
+namespace bulk {
+
+
+// Instruction sets kernels may use, the best one supported is detected on first use
+enum ISA {
+    scalar,
+    sse41,
+    avx2,
+};
+
+ISA isa();
+ISA isa(ISA limit);     // Lowers (or restores) the one in use, returns the previous one
+
+// BMI2 (PDEP/PEXT) is orthogonal to the above, used if the CPU has it
+bool bmi2();
+bool bmi2(bool use);    // Turns it off (or back on), returns the previous state
+
+
+// Byte aligned big endian items to native ones
+void swap(const char *data, uint16_t *out, unsigned long n);
+void swap(const char *data, uint32_t *out, unsigned long n);
+void swap(const char *data, uint64_t *out, unsigned long n);
+
+// Native items to byte aligned big endian ones
+void swap(const uint16_t *in, char *data, unsigned long n);
+void swap(const uint32_t *in, char *data, unsigned long n);
+void swap(const uint64_t *in, char *data, unsigned long n);
+
+// Packed 1, 2 or 4 bit items, the first one starting on a byte boundary, to a byte each
+void unpack(const char *data, uint8_t *out, unsigned long n, long bits, Endianness endianness);
+
+// And back, bits beyond the last item are preserved
+void pack(const uint8_t *in, char *data, unsigned long n, long bits, Endianness endianness);
+
+// Packed items of any size up to the output's, the first one starting offset (< 8) bits
+// into data, to one output item each. And back, bits around the items are preserved.
+void unpack(const char *data, uint8_t  *out, unsigned long n, long bits, Endianness endianness, long offset);
+void unpack(const char *data, uint16_t *out, unsigned long n, long bits, Endianness endianness, long offset);
+void pack(const uint8_t  *in, char *data, unsigned long n, long bits, Endianness endianness, long offset);
+void pack(const uint16_t *in, char *data, unsigned long n, long bits, Endianness endianness, long offset);
+
+// Index of the first ch among n bytes starting bits (< 8) into data, n if there's none.
+// With bits, one byte past the n is read.
+long find(const char *data, unsigned long n, char ch, long bits = 0);
+
+
+// Codec<...>::kernel tells whether the layout has bulk kernels
+template <long size, long offset, Endianness endianness, typename signedness,
+          bool aligned = offset % 8 == 0 && (size == 8 || size == 16 || size == 32 || size == 64),
+          bool packed  = offset % 8 == 0 && (size == 1 || size == 2 || size == 4) && !std::is_signed<signedness>::value,
+          bool spread  = !aligned && !packed && size <= 16 && !std::is_signed<signedness>::value>
+struct Codec {
+    static const bool kernel = false;
+};
+
+template <long size, long offset, Endianness endianness, typename signedness>
+struct Codec<size, offset, endianness, signedness, true, false, false> {
+    static const bool kernel = true;
+    using type = typename integral::Type<size, unsigned>::type_t;
+
+    template <typename T>
+    static void get(const char *buffer, T *out, unsigned long n) {
+        static_assert(sizeof(T) == sizeof(type), "items are decoded in place");
+        Swappable<size != 8 && endianness != machine::endianness>::get(
+            buffer + offset / 8, reinterpret_cast<type *>(out), n);
+    }
+
+    template <typename T>
+    static void set(char *buffer, const T *in, unsigned long n) {
+        static_assert(sizeof(T) == sizeof(type), "items are encoded in place");
+        Swappable<size != 8 && endianness != machine::endianness>::set(
+            buffer + offset / 8, reinterpret_cast<const type *>(in), n);
+    }
+
+private:
+    template <bool swap, typename U = void>
+    struct Swappable {
+        static void get(const char *buffer, type *out, unsigned long n) {
+            std::memcpy(out, buffer, n * sizeof(type));
+        }
+        static void set(char *buffer, const type *in, unsigned long n) {
+            std::memcpy(buffer, in, n * sizeof(type));
+        }
+    };
+
+    template <typename U>
+    struct Swappable<true, U> {
+        static void get(const char *buffer, type *out, unsigned long n) {
+            bulk::swap(buffer, out, n);
+        }
+        static void set(char *buffer, const type *in, unsigned long n) {
+            bulk::swap(in, buffer, n);
+        }
+    };
+};
+
+template <long size, long offset, Endianness endianness, typename signedness>
+struct Codec<size, offset, endianness, signedness, false, true, false> {
+    static const bool kernel = true;
+
+    static void get(const char *buffer, uint8_t *out, unsigned long n) {
+        bulk::unpack(buffer + offset / 8, out, n, size, endianness);
+    }
+
+    static void set(char *buffer, const uint8_t *in, unsigned long n) {
+        bulk::pack(in, buffer + offset / 8, n, size, endianness);
+    }
+};
+
+template <long size, long offset, Endianness endianness, typename signedness>
+struct Codec<size, offset, endianness, signedness, false, false, true> {
+    static const bool kernel = true;
+    using type = typename integral::Type<size, unsigned>::type_t;
+
+    template <typename T>
+    static void get(const char *buffer, T *out, unsigned long n) {
+        static_assert(sizeof(T) == sizeof(type), "items are decoded in place");
+        bulk::unpack(buffer + offset / 8, reinterpret_cast<type *>(out), n, size, endianness, offset % 8);
+    }
+
+    template <typename T>
+    static void set(char *buffer, const T *in, unsigned long n) {
+        static_assert(sizeof(T) == sizeof(type), "items are encoded in place");
+        bulk::pack(reinterpret_cast<const type *>(in), buffer + offset / 8, n, size, endianness, offset % 8);
+    }
+};
+
+
+}}} // namespace bitstream::machine::bulk
+
+
+#endif // __BITSTREAM_MACHINE_BULK_H__
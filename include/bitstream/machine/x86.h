@@ -1,6 +1,10 @@
 #ifndef __BITSTREAM_MACHINE_X86_H__
 #define __BITSTREAM_MACHINE_X86_H__
 
+#include <cstring>
+#ifdef __BMI2__
+#   include <immintrin.h>
+#endif
 
 namespace bitstream {
 namespace machine {
@@ -198,6 +202,22 @@ struct shift<0> {
     }
 };
 
+// Lowest count bits of a value. With BMI2 (-mbmi2) masks not fitting an immediate
+// are replaced by BZHI, which takes the count instead of a 64-bit constant.
+template <long count>
+struct low {
+
+    template <typename T>
+    static T bits(const T &value) {
+#   ifdef __BMI2__
+        if (count > 32 && sizeof(T) == sizeof(uint64_t)) {
+            return T(_bzhi_u64(uint64_t(value), unsigned(count)));
+        }
+#   endif
+        return value & T(T(~T(0)) >> (8 * sizeof(T) - count));
+    }
+};
+
 
 template <long offset, long size, Endianness endianness,
          typename type = typename integral::Type<size, unsigned>::type_t>
@@ -238,8 +258,7 @@ struct Value {
             word_t word = Memory<word_alignment>::template get<word_t>(buffer);
             word = Flippable<do_flip>::template flip<xbytes>(word);
             word = shift<lsb>::right(word);
-            word &= mask_size;
-            return word;
+            return low<size>::bits(word);
         }
 
         static void set(char *buffer, type value) {
@@ -308,6 +327,131 @@ struct Value {
 };
 
 
+// Codec for a bit offset known only at runtime: a single unaligned load into the
+// smallest word covering the item at any offset within a byte, then shifts and
+// masks. Only the bytes the item spans at its offset are read and written back,
+// so the last item of an array never touches the bytes past its end. Items which
+// may span more than 64 bits take a 9th byte along.
+template <long size, Endianness endianness,
+         typename type = typename integral::Type<size, unsigned>::type_t>
+struct Runtime {
+
+    static const bool extended = size + 7 > 64;
+    static const long word_xsize = extended ? 64 : size + 7;
+
+    using word_t = typename integral::Type<word_xsize, unsigned>::type_t;
+
+    static const long word_bits = 8 * sizeof(word_t);
+    static const word_t mask_size = word_t(~word_t(0)) >> (word_bits - size);
+    static const bool do_flip = machine::endianness != endianness;
+
+    // Bytes spanned at a bit offset of 0, one more when the item straddles them
+    static const long bytes = (size + 7) / 8;
+    static const long straddling_bytes = (size + 14) / 8;
+
+    static long straddling(long lbits) {
+        return straddling_bytes != bytes && lbits + size > 8 * bytes;
+    }
+
+    // The item's last byte, at bytes - 1 + straddling, is read (and written) on its own: it's
+    // either past the first bytes or one of them already, so there's no branch and nothing
+    // past the item is touched
+    static word_t load(const char *buffer, long lbits) {
+        word_t word = 0;
+        std::memcpy(&word, buffer, bytes);
+        if (straddling_bytes != bytes) {
+            long last = bytes - 1 + straddling(lbits);
+            word |= word_t(uint8_t(buffer[last])) << 8 * last;
+        }
+        return word;
+    }
+
+    static void store(char *buffer, long lbits, word_t word) {
+        std::memcpy(buffer, &word, bytes);
+        if (straddling_bytes != bytes) {
+            long last = bytes - 1 + straddling(lbits);
+            buffer[last] = char(word >> 8 * last);
+        }
+    }
+
+
+    template <bool extended = Runtime::extended, typename U = void>
+    struct Extendable;
+
+    template <typename U>
+    struct Extendable<false, U> {
+
+        static long shift(long lbits) {
+            return endianness == Endianness::big ? word_bits - lbits - size : lbits;
+        }
+
+        static type get(const char *buffer, long lbits) {
+            word_t word = load(buffer, lbits);
+            word = Flippable<do_flip>::template flip<sizeof(word_t)>(word);
+            return type(low<size>::bits(word_t(word >> shift(lbits))));
+        }
+
+        static void set(char *buffer, long lbits, type value) {
+            word_t word = load(buffer, lbits);
+            word = Flippable<do_flip>::template flip<sizeof(word_t)>(word);
+            word &= ~(mask_size << shift(lbits));
+            word |= (word_t(value) & mask_size) << shift(lbits);
+            store(buffer, lbits, Flippable<do_flip>::template flip<sizeof(word_t)>(word));
+        }
+    };
+
+    template <typename U>
+    struct Extendable<true, U> {
+
+        using xword_t = unsigned __int128;  // 72 significant bits: the word and the extension byte
+        static const long xword_bits = 8 * sizeof(word_t) + 8;
+
+        static long shift(long lbits) {
+            return endianness == Endianness::big ? xword_bits - lbits - size : lbits;
+        }
+
+        // The word always lies within the item, the extension byte as above
+        static xword_t load(const char *buffer, long lbits) {
+            word_t word = Memory<0>::template get<word_t>(buffer);
+            word = Flippable<do_flip>::template flip<sizeof(word_t)>(word);
+            long extra = lbits + size > word_bits;
+            xword_t extension = uint8_t(buffer[sizeof(word_t) - 1 + extra]) & -extra;
+            return endianness == Endianness::big
+                ? xword_t(word) << 8 | extension
+                : xword_t(word) | extension << 8 * sizeof(word_t);
+        }
+
+        static void store(char *buffer, long lbits, xword_t xword) {
+            word_t word = endianness == Endianness::big ? word_t(xword >> 8) : word_t(xword);
+            uint8_t extension = endianness == Endianness::big ? uint8_t(xword) : uint8_t(xword >> 8 * sizeof(word_t));
+            Memory<0>::set(buffer, Flippable<do_flip>::template flip<sizeof(word_t)>(word));
+            long last = sizeof(word_t) - 1 + (lbits + size > word_bits);
+            buffer[last] = last == sizeof(word_t) ? char(extension) : buffer[last];
+        }
+
+        static type get(const char *buffer, long lbits) {
+            return type((load(buffer, lbits) >> shift(lbits)) & mask_size);
+        }
+
+        static void set(char *buffer, long lbits, type value) {
+            xword_t xword = load(buffer, lbits);
+            xword &= ~(xword_t(mask_size) << shift(lbits));
+            xword |= xword_t(word_t(value) & mask_size) << shift(lbits);
+            store(buffer, lbits, xword);
+        }
+    };
+
+
+    static type get(const char *buffer, long offset) {
+        return Extendable<>::get(buffer + offset / 8, offset % 8);
+    }
+
+    static void set(char *buffer, long offset, type value) {
+        Extendable<>::set(buffer + offset / 8, offset % 8, value);
+    }
+};
+
+
 }} // namespace bitstream::machine
 
 
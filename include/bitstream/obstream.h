@@ -0,0 +1,114 @@
+#ifndef __BITSTREAM_OBSTREAM_H__
+#define __BITSTREAM_OBSTREAM_H__
+
+#include <stdint.h>
+#include <charconv>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+namespace bitstream {
+namespace output {
+namespace buffered {
+
+
+// Append only text buffer in front of an ostream or a file descriptor. Numbers are
+// formatted with std::to_chars, nothing is written until the buffer is full, flush()
+// is called or commit() finds it past the threshold.
+//
+// It's an std::ostream too, over a streambuf appending to the same buffer: manipulators
+// and anything else an ostream takes work as usual, once the format state differs from
+// the default (std::setw, std::hex...) items go through the iostream formatting instead.
+struct Stream: std::ostream {
+
+    struct Sink;
+    struct Streambuf;
+    struct Width { long width; };   // Left aligned, applies to the next item only
+
+    Stream(std::ostream &out, unsigned long capacity = 1 << 20, unsigned long threshold = 1 << 16);
+    Stream(int fd, unsigned long capacity = 1 << 20, unsigned long threshold = 1 << 16);
+    ~Stream();
+
+    Stream &write(const char *data, unsigned long size) {
+        append(data, size);
+        if (width_ != 0) {
+            pad(size);
+        }
+        return *this;
+    }
+
+    Stream &operator << (std::string_view string) { return width() ? format(string) : write(string.data(), string.size()); }
+    Stream &operator << (const std::string &string) { return *this << std::string_view(string); }
+    Stream &operator << (const char *string) { return *this << std::string_view(string); }
+    Stream &operator << (char ch) { return width() ? format(ch) : write(&ch, sizeof(ch)); }
+    Stream &operator << (signed char ch) { return *this << char(ch); }
+    Stream &operator << (unsigned char ch) { return *this << char(ch); }
+
+    // Templates take exactly bool and the integral types: a plain bool overload would take
+    // pointers, manipulators included, as well
+    template <typename Bool, std::enable_if_t<std::is_same<Bool, bool>::value, int> = 0>
+    Stream &operator << (Bool value) { return plain() ? *this << char('0' + value) : format(value); }
+
+    template <typename Integer, std::enable_if_t<std::is_integral<Integer>::value && !std::is_same<Integer, bool>::value, int> = 0>
+    Stream &operator << (Integer value) {
+        if (!plain()) {
+            return format(value);
+        }
+        char digits[24];
+        auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        return write(digits, end - digits);
+    }
+
+    Stream &operator << (double value);     // As iostreams do by default: %g, 6 digits
+    Stream &operator << (Width width) { width_ = width.width; return *this; }
+
+    // std::endl is just a new line here, std::flush flushes, others apply to the ostream
+    Stream &operator << (std::ostream &(*manipulator)(std::ostream &));
+    Stream &operator << (std::ios_base &(*manipulator)(std::ios_base &)) { manipulator(*this); return *this; }
+
+    void commit() {     // Event boundary
+        if (buffer.size() >= threshold) {
+            flush();
+        }
+    }
+    void flush();
+
+    unsigned long buffered() const { return buffer.size(); }
+
+private:
+    std::unique_ptr<Sink> sink;
+    std::unique_ptr<Streambuf> streambuf;
+    std::string buffer;
+    unsigned long capacity, threshold;
+    long width_ = 0;
+
+    void append(const char *data, unsigned long size) {
+        if (buffer.size() + size > capacity) {
+            flush();
+        }
+        buffer.append(data, size);
+    }
+    void pad(unsigned long size);
+
+    bool plain() const { return width() == 0 && flags() == (std::ios_base::skipws | std::ios_base::dec); }
+
+    template <typename Type>
+    Stream &format(const Type &value) {
+        static_cast<std::ostream &>(*this) << value;
+        return *this;
+    }
+};
+
+
+inline Stream::Width width(long width) {
+    return Stream::Width{width};
+}
+
+
+}}} // namespace bitstream::output::buffered
+
+
+#endif // __BITSTREAM_OBSTREAM_H__
@@ -0,0 +1,136 @@
+#ifndef __BITSTREAM_OJSTREAM_H__
+#define __BITSTREAM_OJSTREAM_H__
+
+#include <string_view>
+#include <bitstream/parser.h>
+#include <bitstream/omstream.h>
+#include <bitstream/obstream.h>
+
+
+namespace bitstream {
+namespace output {
+namespace json {
+
+
+// Newline delimited JSON: one compact object per header (and per payload, per
+// error), "depth" follows the payload boundaries. For a box that is:
+//
+// {"header":"box","size":28,"offset":0,"depth":0,"fields":{"size":28,"type":"moov"}}
+//
+// Fields formatted as "fourcc" or "string" are emitted as strings, any other as
+// numbers or arrays of them. Lines are buffered up to the end of a top level
+// payload boundary, flush() before writing to the same output directly.
+struct Stream: Parser::Observer, meta::header::Stream, meta::field::Stream, meta::payload::Stream {
+
+    Stream(int fd);
+    Stream(std::ostream &out);
+
+    void flush() { out.flush(); }
+
+    virtual bool ellipses(long index, long count) { return false; }
+    virtual void header(const Tag &tag, const char *buffer);
+
+    virtual void field(const Tag &tag,  uint8_t value) { number(tag, value); }
+    virtual void field(const Tag &tag, uint16_t value) { number(tag, value); }
+    virtual void field(const Tag &tag, uint32_t value) { number(tag, value); }
+    virtual void field(const Tag &tag, uint64_t value) { number(tag, value); }
+    virtual void field(const Tag &tag,   int8_t value) { number(tag, value); }
+    virtual void field(const Tag &tag,  int16_t value) { number(tag, value); }
+    virtual void field(const Tag &tag,  int32_t value) { number(tag, value); }
+    virtual void field(const Tag &tag,  int64_t value) { number(tag, value); }
+    virtual void field(const Tag &tag, const std::string &value) { string(tag, value); }
+    virtual void field(const Tag &tag, std::string_view value) { string(tag, value); }
+
+    virtual void field(const Tag &tag, const std::vector< uint8_t> &value) { bytes(tag, value); }
+    virtual void field(const Tag &tag, const std::vector<uint16_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector<uint32_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector<uint64_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector<  int8_t> &value) { bytes(tag, value); }
+    virtual void field(const Tag &tag, const std::vector< int16_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector< int32_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector< int64_t> &value) { array(tag, value); }
+    virtual void field(const Tag &tag, const std::vector<std::string> &value) { array(tag, value); }
+
+    BITSTREAM_META_FIELD_VIEWS(view)
+
+    virtual void payload(const Tag &tag, const bitstream::Blob &);
+
+protected:  // Parser::Observer interface implementation
+    virtual void event(const Parser::Event::Exception &);
+    virtual void event(const Parser::Event::Payload::Data &event);
+    virtual void event(const Parser::Event::Payload::Boundary::Begin &event);
+    virtual void event(const Parser::Event::Payload::Boundary::End &event);
+    virtual void event(const Parser::Event::Header &event);
+
+private:
+    buffered::Stream out;
+    long depth = 0;
+    long open = 0;          // Objects of the header line: the header, its fields
+    bool fields = false;    // Any field written already
+
+    void close();
+    bool key(const Tag &tag);
+    bool as_string(const Tag &tag) const;   // Formatted as "fourcc" or "string"
+    void fourcc(uint32_t value);
+
+    template <typename Number>
+    void item(Number value) { out << +value; }
+    void item(const std::string &value);
+
+    template <typename Number>
+    void number(const Tag &tag, Number value) {
+        if (key(tag)) {
+            if (sizeof(value) == 4 && as_string(tag)) {
+                fourcc(uint32_t(value));
+            } else {
+                item(value);
+            }
+        }
+    }
+
+    void string(const Tag &tag, std::string_view value);
+
+    template <typename Byte>
+    void bytes(const Tag &tag, const std::vector<Byte> &value) {
+        if (as_string(tag)) {
+            string(tag, std::string_view(reinterpret_cast<const char *>(value.data()), value.size()));
+        } else {
+            array(tag, value);
+        }
+    }
+
+    template <typename Type>
+    void view(const Tag &tag, const View<Type> &value) {
+        if (sizeof(Type) == 1 && as_string(tag)) {    // Byte arrays, as the vectors of them
+            bytes(tag, value.vector());
+        } else {
+            array(tag, value);
+        }
+    }
+
+    template <typename Array>
+    void array(const Tag &tag, const Array &value) {
+        if (key(tag)) {
+            out << '[';
+            for (unsigned long i = 0; i < value.size(); ++i) {
+                if (i != 0) {
+                    out << ',';
+                }
+                item(value[i]);
+            }
+            out << ']';
+        }
+    }
+};
+
+
+// Quoted and escaped JSON string. Valid UTF-8 goes as is, other bytes above
+// 0x7F are taken for Latin-1 code points. Runs of bytes needing no escape are
+// found 16 or 32 at a time where the CPU can (see machine::bulk::isa()).
+void quote(buffered::Stream &out, std::string_view string);
+
+
+}}} // namespace bitstream::output::json
+
+
+#endif // __BITSTREAM_OJSTREAM_H__
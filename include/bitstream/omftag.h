@@ -1,6 +1,7 @@
 #ifndef __BITSTREAM_OMFTAG_H__
 #define __BITSTREAM_OMFTAG_H__
 
+#include <type_traits>
 #include <bitstream/field.h>
 #include <bitstream/array.h>
 #include <bitstream/string.h>
@@ -27,14 +28,17 @@ struct Type : std::string {
 };
 
 struct Format {
+    using Id = meta::Stream::Tag::Formatters::Id;
+
     Format(const std::string &how, const std::string &what = "value")
-        : what(what), how(how) { }
+        : what(meta::Stream::Tag::Formatters::id(what)), how(meta::Stream::Tag::Formatters::id(how)) { }
+    Format(Id how, Id what) : what(what), how(how) { }    // Already interned
 
-    std::string what, how;
+    Id what, how;
 };
 
 inline void operator << (meta::Stream::Tag &tag, const Format &format) {
-    tag.formatters[format.what] = format.how;
+    tag.formatters.set(format.what, format.how);
 }
 
 inline void operator << (meta::Stream::Tag &tag, const Offset &offset) {
@@ -58,18 +62,28 @@ inline void operator << (meta::Stream::Tag &tag, const char *name) {
 }
 
 
+// Tag of a type is built once, then only referenced
+template <typename From>
+struct Once {
+    static const meta::Stream::Tag &type() {
+        static const meta::Stream::Tag tag = From::make();
+        return tag;
+    }
+};
+
 template <typename Type>
-struct From {
-    static meta::Stream::Tag type() {
+struct From: Once<From<Type>> {
+    static meta::Stream::Tag make() {
         return meta::Stream::Tag();
     }
 };
 
 template <long size, long offset, Endianness endianness, typename signedness>
-struct From<Field<size, offset, endianness, signedness>> {
+struct From<Field<size, offset, endianness, signedness>>
+    : Once<From<Field<size, offset, endianness, signedness>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = size;
         tag.offset = offset;
@@ -79,10 +93,11 @@ struct From<Field<size, offset, endianness, signedness>> {
 
 
 template <long size, long offset, Endianness endianness, typename signedness>
-struct From<Array<Field<size, offset, endianness, signedness>>> {
+struct From<Array<Field<size, offset, endianness, signedness>>>
+    : Once<From<Array<Field<size, offset, endianness, signedness>>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = size;
         tag.offset = offset;
@@ -91,10 +106,11 @@ struct From<Array<Field<size, offset, endianness, signedness>>> {
 };
 
 template <long size, long offset, Endianness endianness, typename signedness, long items>
-struct From<Static::Array<Field<size, offset, endianness, signedness>, items>> {
+struct From<Static::Array<Field<size, offset, endianness, signedness>, items>>
+    : Once<From<Static::Array<Field<size, offset, endianness, signedness>, items>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = size;
         tag.offset = offset;
@@ -104,10 +120,11 @@ struct From<Static::Array<Field<size, offset, endianness, signedness>, items>> {
 
 
 template <long offset>
-struct From<bitstream::String<offset>> {
+struct From<bitstream::String<offset>>
+    : Once<From<bitstream::String<offset>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = 8;
         tag.offset = offset;
@@ -119,10 +136,11 @@ struct From<bitstream::String<offset>> {
 
 
 template <long items, long offset>
-struct From<bitstream::Static::String<items, offset>> {
+struct From<bitstream::Static::String<items, offset>>
+    : Once<From<bitstream::Static::String<items, offset>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = 8;
         tag.offset = offset;
@@ -134,10 +152,11 @@ struct From<bitstream::Static::String<items, offset>> {
 
 
 template <long offset>
-struct From<bitstream::CString<offset>> {
+struct From<bitstream::CString<offset>>
+    : Once<From<bitstream::CString<offset>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = 8;
         tag.offset = offset;
@@ -149,10 +168,11 @@ struct From<bitstream::CString<offset>> {
 
 
 template <long items, long offset>
-struct From<bitstream::Static::CString<items, offset>> {
+struct From<bitstream::Static::CString<items, offset>>
+    : Once<From<bitstream::Static::CString<items, offset>>> {
 
     static meta::Stream::Tag
-    type() {
+    make() {
         meta::Stream::Tag tag;
         tag.size = 8;
         tag.offset = offset;
@@ -179,6 +199,44 @@ struct To<Field<size, offset, endianness, signedness>> {
     }
 };
 
+// Arrays are emitted as views into the buffer, only the items looked at get decoded
+template <typename Array>
+struct Viewed {
+    using Type = typename Array::Type;
+
+    static meta::Stream::View<Type>
+    value(const Array &array, unsigned long items) {
+        return {&array, items, item, decode};
+    }
+
+    static Type item(const void *array, unsigned long index) {
+        return (*static_cast<const Array *>(array))[index];
+    }
+
+    static void decode(const void *array, Type *out, unsigned long n) {
+        static_cast<const Array *>(array)->decode_into(out, n);
+    }
+};
+
+template <long size, long offset, Endianness endianness, typename signedness, long items>
+struct To<Static::Array<Field<size, offset, endianness, signedness>, items>> {
+
+    static auto
+    value(const Static::Array<Field<size, offset, endianness, signedness>, items> &array) {
+        return Viewed<Static::Array<Field<size, offset, endianness, signedness>, items>>::value(array, items);
+    }
+};
+
+template <long size, long offset, Endianness endianness, typename signedness>
+struct To<Array<Field<size, offset, endianness, signedness>>> {
+
+    static auto
+    value(const Array<Field<size, offset, endianness, signedness>> &array) {
+        return Viewed<Array<Field<size, offset, endianness, signedness>>>::value(array, array.items);
+    }
+};
+
+
 template <long offset>
 struct To<bitstream::String<offset>> {
 
@@ -219,6 +277,48 @@ struct To<bitstream::Static::CString<items, offset>> {
 };
 
 
+// Byte aligned strings are emitted as views into the buffer, no copy. C strings
+// keep their whole buffer (terminator included), same as the unaligned ones.
+template <>
+struct To<bitstream::String<0>> {
+
+    static std::string_view
+    value(const bitstream::String<0> &value) {
+        return value.view();
+    }
+};
+
+
+template <long items>
+struct To<bitstream::Static::String<items, 0>> {
+
+    static std::string_view
+    value(const bitstream::Static::String<items, 0> &value) {
+        return value.view();
+    }
+};
+
+
+template <>
+struct To<bitstream::CString<0>> {
+
+    static std::string_view
+    value(const bitstream::CString<0> &value) {
+        return static_cast<const bitstream::String<0> &>(value).view();
+    }
+};
+
+
+template <long items>
+struct To<bitstream::Static::CString<items, 0>> {
+
+    static std::string_view
+    value(const bitstream::Static::CString<items, 0> &value) {
+        return static_cast<const bitstream::Static::String<items, 0> &>(value).view();
+    }
+};
+
+
 struct Stream {
 
     meta::field::Stream &stream;
@@ -261,6 +361,40 @@ struct Stream {
         t.tag.size = Array::template Item<>::size;
         return t;
     }
+
+
+    // Same, but the tag is defined once per call site (the definition is a
+    // lambda, its type is unique) and afterwards only the value is emitted:
+    //
+    //     fields.tag(size, [](auto &tag) { tag << "size"; });
+    //
+    struct Definition {
+        meta::Stream::Tag tag;
+
+        template <typename Feature>
+        Definition &operator << (const Feature &feature) { tag << feature; return *this; }
+    };
+
+    template <typename Type, typename Define>
+    static const meta::Stream::Tag &defined(Define define) {
+        static_assert(std::is_empty<Define>::value, "Tag definition runs once, it can't capture");
+        static const meta::Stream::Tag tag = [&define] {
+            Definition definition{meta::field::tag::From<Type>::type()};
+            define(definition);
+            return definition.tag;
+        }();
+        return tag;
+    }
+
+    template <typename Value, typename Define>
+    void tag(const Value &value, Define define) const {
+        stream.field(defined<Value>(define), meta::field::tag::To<Value>::value(value));
+    }
+
+    template <typename Type, typename Value, typename Define>
+    void typed_tag(const Value &value, Define define) const {
+        stream.field(defined<Type>(define), meta::field::tag::To<Value>::value(value));
+    }
 };
 
 
@@ -3,8 +3,9 @@
 
 #include <stdint.h>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 
 
 namespace bitstream {
@@ -21,6 +22,7 @@ namespace meta {
 
 struct Stream {
     struct Tag;
+    template <typename Type> struct View;
 };
 
 
@@ -30,15 +32,79 @@ struct Stream::Tag {
     unsigned long offset = 0;   // Bits
     std::string type;
 
-    struct: std::unordered_map<std::string, std::string> {
+    // Formatter names are interned into small ids once, a tag keeps the
+    // (what, how) id pairs it overrides, any other "what" is formatted by itself
+    struct Formatters {
+        using Id = unsigned;
+        static constexpr Id none = Id(-1);
+        static Id id(const std::string &name);
+        static Id find(const std::string &name);    // Not interning it, none if it isn't
+        static const std::string &name(Id id);
+
+        Id get(Id what, Id default_how) const {
+            for (auto &item: overrides) {
+                if (item.first == what) {
+                    return item.second;
+                }
+            }
+            return default_how;
+        }
+        Id get(Id what) const { return get(what, what); }
+
         std::string get(const std::string &name, const std::string &default_name = "") const {
-            auto it = find(name);
-            return (it != end()) ? it->second : (default_name.empty() ? name: default_name);
+            return Formatters::name(get(id(name), id(default_name.empty() ? name: default_name)));
+        }
+
+        void set(Id what, Id how) {
+            for (auto &item: overrides) {
+                if (item.first == what) {
+                    item.second = how;
+                    return;
+                }
+            }
+            overrides.emplace_back(what, how);
         }
+
+        bool empty() const { return overrides.empty(); }
+
+    private:
+        std::vector<std::pair<Id, Id>> overrides;
     } formatters;
 };
 
 
+// Array left in its buffer: items are decoded one by one when asked for by
+// index, all at once only when it's materialized into a vector
+template <typename Type>
+struct Stream::View {
+    const void *array;
+    unsigned long items;
+    Type (*item)(const void *array, unsigned long index);
+    void (*decode)(const void *array, Type *out, unsigned long n);
+
+    unsigned long size() const { return items; }
+    Type operator [] (unsigned long index) const { return item(array, index); }
+
+    std::vector<Type> vector() const {
+        std::vector<Type> v(items);
+        decode(array, v.data(), items);
+        return v;
+    }
+};
+
+
+// Overloads for the lazy arrays of every item type, all forwarding to the same template
+#define BITSTREAM_META_FIELD_VIEWS(forward) \
+    virtual void field(const Tag &tag, const View< uint8_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View<uint16_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View<uint32_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View<uint64_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View<  int8_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View< int16_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View< int32_t> &value) { forward(tag, value); } \
+    virtual void field(const Tag &tag, const View< int64_t> &value) { forward(tag, value); }
+
+
 namespace header {
 
 struct Stream: meta::Stream {
@@ -62,6 +128,9 @@ struct Stream: meta::Stream {
     virtual void field(const Tag &tag,  int32_t value) = 0;
     virtual void field(const Tag &tag,  int64_t value) = 0;
     virtual void field(const Tag &tag, const std::string &value) = 0;
+    virtual void field(const Tag &tag, std::string_view value) {  // Zero-copy strings
+        field(tag, std::string(value));
+    }
 
     virtual void field(const Tag &tag, const std::vector< uint8_t> &value) = 0;
     virtual void field(const Tag &tag, const std::vector<uint16_t> &value) = 0;
@@ -72,6 +141,11 @@ struct Stream: meta::Stream {
     virtual void field(const Tag &tag, const std::vector< int32_t> &value) = 0;
     virtual void field(const Tag &tag, const std::vector< int64_t> &value) = 0;
     virtual void field(const Tag &tag, const std::vector<std::string> &value) = 0;
+
+    // Lazy arrays, materialized for streams which don't index them
+    template <typename Type>
+    void materialized(const Tag &tag, const View<Type> &value) { field(tag, value.vector()); }
+    BITSTREAM_META_FIELD_VIEWS(materialized)
 };
 
 } // namespace field
@@ -3,8 +3,8 @@
 
 
 #include <iostream>
-#include <unordered_map>
 #include <bitstream/parser.h>
+#include <bitstream/obstream.h>
 #include <bitstream/omstream.h>
 #include <bitstream/signedness.h>
 
@@ -22,14 +22,20 @@ struct Stream {
     struct Indent;
     void indent(const std::string &pattern, bool in = true);
 
-    std::ostream &ierr();                                   // indented err
-    std::ostream &iout(const std::string &pattern = "");    // indented out
+    buffered::Stream &ierr();                                   // indented err
+    buffered::Stream &iout(const std::string &pattern = "");    // indented out
 
-    std::ostream &out;
-    std::ostream &err;
+    // Buffered in front of the given ostreams, written through on flush(), whenever
+    // an event leaves more than a threshold behind and when a top level payload
+    // boundary ends. Call flush() before writing to the ostreams directly. Both are
+    // std::ostreams as well, std::setw, std::hex and the like keep working on them.
+    buffered::Stream out;
+    buffered::Stream err;
 
     Stream(std::ostream &out, std::ostream &err, bool indent_top_level = true);
 
+    void flush();
+
 private:
     std::string _indentation;
 };
@@ -75,13 +81,34 @@ struct Stream: indented::Stream, Parser::Observer {
     std::string signed_number   = Signedness<signed>::string;
     std::string char_type       = "char";
     char non_printing_char      = '?';
+    // Formatter name interned as it's set, arrays look it up by id
+    struct FormatterName {
+        using Id = meta::Stream::Tag::Formatters::Id;
+        FormatterName(const std::string &name = "") { *this = name; }
+        FormatterName &operator = (const std::string &name);
+        operator const std::string & () const { return name; }
+        bool empty() const { return name.empty(); }
+        Id id() const { return id_; }
+    private:
+        std::string name;
+        Id id_;
+    };
+
     // <empty> == "array" and "array == "oneline_array" by default
-    std::string default_array_formatter;// array | oneline_array | multiline_array
+    FormatterName default_array_formatter;// array | oneline_array | multiline_array
 
     std::string multiline_array_item_indent = std::string(4, ' ');
 
     bool ellipses(long item, long total_items);
 
+    // Arrays longer than ellipses_items.before + after print just those items,
+    // the rest aren't decoded at all
+    bool array_ellipses     = false;
+    bool array_ellipsis(long item, long total_items) const {
+        return array_ellipses && total_items > (ellipses_items.before + ellipses_items.after) &&
+               item == ellipses_items.before;
+    }
+
     struct Formatter;
     using indented::Stream::Stream;
 
@@ -89,6 +116,8 @@ private:
     struct Brackets;
     struct Meta;
 
+    long depth = 0;     // Of payload boundaries
+
 protected:  // Parser::Observer interface implementation
     virtual void event(const Parser::Event::Exception &);
     virtual void event(const Parser::Event::Payload::Data &event);
@@ -99,6 +128,17 @@ protected:  // Parser::Observer interface implementation
 } extern to_stdout;
 
 
+// Overloads for the lazy arrays of every item type, all forwarding to the same template
+#define BITSTREAM_PRINT_FORMATTER_VIEWS(forward) \
+    virtual void field(Stream &stream, const Tag &tag, const View< uint8_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View<uint16_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View<uint32_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View<uint64_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View<  int8_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View< int16_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View< int32_t> &value) { forward(stream, tag, value); } \
+    virtual void field(Stream &stream, const Tag &tag, const View< int64_t> &value) { forward(stream, tag, value); }
+
 struct Stream::Formatter {
     using Tag = meta::Stream::Tag;
     struct Registry;
@@ -112,6 +152,9 @@ struct Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int32_t value) = 0;
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) = 0;
     virtual void field(Stream &stream, const Tag &tag, const std::string &value) = 0;
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) {
+        field(stream, tag, std::string(value));
+    }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) = 0;
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) = 0;
@@ -122,14 +165,32 @@ struct Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int32_t> &value) = 0;
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) = 0;
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) = 0;
+
+    // Lazy arrays, materialized for formatters which don't index them
+    template <typename Type>
+    using View = meta::Stream::View<Type>;
+
+    template <typename Type>
+    void materialized(Stream &stream, const Tag &tag, const View<Type> &value) { field(stream, tag, value.vector()); }
+    BITSTREAM_PRINT_FORMATTER_VIEWS(materialized)
 };
 
 struct Stream::Formatter::Registry {
+    using Id = Tag::Formatters::Id;
+
     Registry();
     Stream::Formatter& operator [] (const std::string &name);
+    Stream::Formatter& operator [] (Id id) {   // No hashing, ids are interned names
+        if (id >= formatters.size() || formatters[id] == nullptr) {
+            missing(id);
+        }
+        return *formatters[id];
+    }
     void add(const std::string &name, Stream::Formatter& formatter);
 private:
-    std::unordered_map<std::string, Stream::Formatter *> formatters;
+    std::vector<Stream::Formatter *> formatters;   // By id
+    [[noreturn]] void missing(Id id) const;
+    [[noreturn]] void missing(const std::string &name) const;
 } extern registry;
 
 
@@ -149,12 +149,8 @@ struct Parser: Composer {
     long find_char(char ch, long limit) {
         bitstream::String<offset> payload;
         hstream.get(payload, limit + Footprint<0, offset>::bytes_occupied, true);
-        for (long i = 0; i < limit; ++i) {
-            if (payload[i] == ch) {
-                return i;
-            }
-        }
-        return -1;
+        auto i = machine::bulk::find(payload.buffer() + offset / 8, limit, ch, offset % 8);
+        return i != limit ? i : -1;
     }
 
 
@@ -238,6 +234,8 @@ struct Parser::Event::Payload::Boundary::Scope: Parser::Event::Payload::Boundary
 };
 
 struct Parser::Observer {
+    virtual ~Observer() {}
+
     virtual void event(const Event::Exception &) {}
     virtual void event(const Event::Header &) {}
     virtual void event(const Event::Payload::Boundary::Begin &) {}
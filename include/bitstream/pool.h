@@ -0,0 +1,62 @@
+#ifndef __BITSTREAM_POOL_H__
+#define __BITSTREAM_POOL_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+// Work stealing thread pool: every worker runs tasks from the front of its
+// own queue and steals from the back of the others' when it runs dry.
+// The total number of queued tasks is bounded, submit() blocks once it's
+// reached (so don't submit from within tasks unless capacity is enough).
+struct Pool {
+
+    using Task = std::function<void ()>;
+
+    Pool(unsigned threads = std::thread::hardware_concurrency(), unsigned long capacity = 1024);
+    ~Pool();
+
+    void submit(Task task);
+    void wait();    // Until all submitted tasks are done, rethrows the first task's exception
+
+    unsigned threads() const { return unsigned(workers.size()); }
+
+private:
+    Pool(const Pool &) = delete;
+    Pool &operator = (const Pool &) = delete;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex mutex;
+    std::condition_variable not_full, not_empty, idle;
+    unsigned long capacity;
+    unsigned long queued = 0, running = 0;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::atomic<unsigned> next{0};
+
+    bool pop(unsigned index, Task &task);
+    void work(unsigned index);
+};
+
+
+}} // namespace bitstream::parallel
+
+
+#endif // __BITSTREAM_POOL_H__
@@ -0,0 +1,162 @@
+#ifndef __BITSTREAM_SEARCH_H__
+#define __BITSTREAM_SEARCH_H__
+
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+
+// Searches over sorted arrays (anything with random access begin() and end(),
+// e.g. Array::range()), items are decoded lazily and only where probed.
+// All of them return an index.
+namespace bitstream {
+namespace search {
+
+
+// Queries are taken as the container's items, so they compare with no mixed signedness
+template <typename Container>
+using Item = typename std::iterator_traits<decltype(std::declval<const Container &>().begin())>::value_type;
+
+
+// Branch-free binary search, first item not less than value
+template <typename Container>
+long lower_bound(const Container &container, const Item<Container> &value) {
+    auto base = container.begin();
+    long n = container.end() - base;
+    if (n == 0) {
+        return 0;
+    }
+    while (n > 1) {
+        long half = n / 2;
+        base += (base[half - 1] < value) ? half : 0;
+        n -= half;
+    }
+    return (base - container.begin()) + (*base < value);
+}
+
+// First item greater than value
+template <typename Container>
+long upper_bound(const Container &container, const Item<Container> &value) {
+    auto base = container.begin();
+    long n = container.end() - base;
+    if (n == 0) {
+        return 0;
+    }
+    while (n > 1) {
+        long half = n / 2;
+        base += (value < base[half - 1]) ? 0 : half;
+        n -= half;
+    }
+    return (base - container.begin()) + !(value < *base);
+}
+
+// Lower bound found by doubling steps away from hint, then bisecting the last step.
+// O(log d) where d is the distance to the result, so successive nearby lookups are cheap.
+template <typename Container>
+long gallop(const Container &container, const Item<Container> &value, long hint) {
+    auto begin = container.begin();
+    long n = container.end() - begin;
+    hint = std::max(0L, std::min(hint, n - 1));
+    if (n == 0) {
+        return 0;
+    }
+    long low, high;
+    if (begin[hint] < value) {      // Ahead: (low, high]
+        low = hint, high = hint + 1;
+        for (long step = 1; high < n && begin[high] < value; step *= 2) {
+            low = high;
+            high = std::min(n, high + step);
+        }
+        low += 1;
+    } else {                        // Behind: [low, high]
+        low = hint, high = hint;
+        for (long step = 1; low > 0 && !(begin[low - 1] < value); step *= 2) {
+            high = low - 1;
+            low = std::max(0L, low - step);
+        }
+    }
+    return low + std::lower_bound(begin + low, begin + high, value) - (begin + low);
+}
+
+
+// Keys of every `every`th item in Eytzinger (breadth first) order, so that the
+// top levels of the search share a few cache lines and the next ones can be
+// prefetched. Only the last `every` items are probed in the array itself.
+// Build it once per table and keep it along with the array.
+template <typename Container>
+struct Eytzinger {
+
+    using Type = Item<Container>;
+
+    Eytzinger(const Container &container, long every = 16)
+        : container(container), every(std::max(every, 1L)) {
+        long items = container.end() - container.begin();
+        long samples = (items + this->every - 1) / this->every;
+        keys.resize(samples + 1);
+        ranks.resize(samples + 1);
+        long sample = 0;
+        build(1, sample, samples);
+    }
+
+    long lower_bound(const Type &value) const {
+        return find(value, [](const Type &key, const Type &value) { return key < value; });
+    }
+
+    long upper_bound(const Type &value) const {
+        return find(value, [](const Type &key, const Type &value) { return !(value < key); });
+    }
+
+    unsigned long footprint() const { return keys.size() * sizeof(Type) + ranks.size() * sizeof(uint32_t); }
+
+private:
+    Container container;
+    long every;
+    std::vector<Type> keys;         // 1-based Eytzinger order
+    std::vector<uint32_t> ranks;    // Sample number of each key
+
+    void build(unsigned long k, long &sample, long samples) {
+        if (k <= (unsigned long)samples) {
+            build(2 * k, sample, samples);
+            ranks[k] = uint32_t(sample);
+            keys[k] = container.begin()[sample * every];
+            ++sample;
+            build(2 * k + 1, sample, samples);
+        }
+    }
+
+    // First sample for which before(key, value) is false, then the range ending in it
+    template <typename Before>
+    long find(const Type &value, Before before) const {
+        const unsigned long n = keys.size() - 1;
+        unsigned long k = 1;
+        while (k <= n) {
+            __builtin_prefetch(keys.data() + 16 * k);
+            k = 2 * k + before(keys[k], value);
+        }
+        k >>= __builtin_ffsl(~k);   // Undo the right turns taken after the last left one
+
+        auto begin = container.begin();
+        long items = container.end() - begin;
+        long last = k ? long(ranks[k]) * every : items;     // Known to be past the result
+        long first = k ? std::max(0L, last - every + 1) : (n ? (long(n) - 1) * every + 1 : 0);
+        auto i = begin + first;
+        for (long left = last - first; left > 0; --left, ++i) {
+            if (!before(*i, value)) {
+                break;
+            }
+        }
+        return i - begin;
+    }
+};
+
+template <typename Container>
+Eytzinger<Container> eytzinger(const Container &container, long every = 16) {
+    return Eytzinger<Container>(container, every);
+}
+
+
+}} // namespace bitstream::search
+
+
+#endif // __BITSTREAM_SEARCH_H__
@@ -0,0 +1,65 @@
+#ifndef __BITSTREAM_SPLITTER_H__
+#define __BITSTREAM_SPLITTER_H__
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <bitstream/parser.h>
+#include <bitstream/imstream.h>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+// Parses a single stream by several workers, provided its top-level units
+// (e.g. moof/mdat fragments) are independent of each other. A first pass
+// reads only the top-level headers to find unit boundaries, consecutive units
+// are then grouped into ranges of at least `grain` bytes which are parsed
+// concurrently, each by its own parser and observer over its own stream.
+struct Splitter {
+
+    struct Range {
+        uint64_t offset = 0;        // Absolute offset of the first unit
+        uint64_t size = 0;
+        unsigned long units = 0;
+    };
+
+    struct Result {
+        Range range;
+        std::exception_ptr exception;
+        std::unique_ptr<Parser::Observer> observer;
+    };
+
+    // Reads the header of the unit at the stream's offset and returns the size of the whole
+    // unit, header included; EndOfStream before anything is read means there are no more units
+    using Indexer = std::function<uint64_t (bitstream::Stream &)>;
+    using ParserFactory = std::function<std::unique_ptr<Parser> (bitstream::Stream &, Parser::Observer &)>;
+    using ObserverFactory = std::function<std::unique_ptr<Parser::Observer> (const Range &)>;
+    using Merge = std::function<void (Result &)>;  // Called one range at a time, in stream order
+
+    Splitter(Indexer indexer, ParserFactory parser, ObserverFactory observer,
+             unsigned threads = std::thread::hardware_concurrency(), uint64_t grain = 1 << 20);
+
+    // Index pass, payloads are skipped
+    std::vector<Range> index(bitstream::Stream &stream, Remainder remainder = Remainder()) const;
+
+    // Ranges are parsed with parse(Remainder(range.size)) over input::memory::Slice streams
+    std::vector<Result> run(const input::memory::Stream &stream, Merge merge = Merge()) const;
+    std::vector<Result> run(const std::string &path, Merge merge = Merge()) const;  // Maps the file
+
+    Indexer indexer;
+    ParserFactory parser;
+    ObserverFactory observer;
+    unsigned threads;
+    uint64_t grain;     // Smallest range worth a task of its own
+};
+
+
+}} // namespace bitstream::parallel
+
+
+#endif // __BITSTREAM_SPLITTER_H__
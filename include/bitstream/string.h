@@ -1,7 +1,10 @@
 #ifndef __BITSTREAM_STRING_H__
 #define __BITSTREAM_STRING_H__
 
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <bitstream/array.h>
 
 
@@ -17,6 +20,12 @@ struct String: bitstream::be::UInt8<offset>::Static::template Array<items> {
         return std::string(this->buffer(), this->buffer() + this->items);
     }
 
+    // Zero-copy access, only for byte aligned strings
+    template <long o = offset, typename = std::enable_if_t<o == 0>>
+    std::string_view view() const {
+        return std::string_view(this->buffer(), this->items);
+    }
+
     unsigned long size() const { return this->items; }
 
     void operator = (const std::string &str) {
@@ -33,7 +42,14 @@ struct CString: String<items, offset> {
     using String<items, offset>::String;
 
     operator std::string() const {
-        std::string(String<items, offset>::operator std::string ().c_str());
+        return std::string(String<items, offset>::operator std::string ().c_str());
+    }
+
+    // Up to the terminating NUL (or whole buffer if there is none)
+    template <long o = offset, typename = std::enable_if_t<o == 0>>
+    std::string_view view() const {
+        auto end = static_cast<const char *>(std::memchr(this->buffer(), '\0', this->items));
+        return std::string_view(this->buffer(), end ? end - this->buffer() : this->items);
     }
 
     void operator = (const std::string &str) {
@@ -56,6 +72,12 @@ struct String: bitstream::be::UInt8<offset>::Array {
         return std::string(this->buffer(), this->buffer() + this->items);
     }
 
+    // Zero-copy access, only for byte aligned strings
+    template <long o = offset, typename = std::enable_if_t<o == 0>>
+    std::string_view view() const {
+        return std::string_view(this->buffer(), this->items);
+    }
+
     unsigned long size() const { return this->items; }
 
     auto &operator = (const std::string &str) {
@@ -76,6 +98,13 @@ struct CString: String<offset> {
         return std::string(String<offset>::operator std::string ().c_str());
     }
 
+    // Up to the terminating NUL (or whole buffer if there is none)
+    template <long o = offset, typename = std::enable_if_t<o == 0>>
+    std::string_view view() const {
+        auto end = static_cast<const char *>(std::memchr(this->buffer(), '\0', this->items));
+        return std::string_view(this->buffer(), end ? end - this->buffer() : this->items);
+    }
+
     auto &operator = (const std::string &str) {
         assert(str.size() + sizeof('\0') == this->items);
         for (auto i = 0; i < str.size(); ++i) {
@@ -0,0 +1,243 @@
+#ifndef __BITSTREAM_VIEWS_H__
+#define __BITSTREAM_VIEWS_H__
+
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+
+// Decoded views over tables parsed as arrays (anything with random access begin()
+// and end()). Nothing is expanded, a checkpoint every `every` entries keeps the
+// cost of a query at a binary search over checkpoints plus at most `every` steps.
+namespace bitstream {
+namespace view {
+
+
+// Running sums of the items, e.g. sample offsets from sample sizes (stsz) or
+// decoding times from per sample durations
+template <typename Container>
+struct PrefixSum {
+
+    PrefixSum(const Container &container, uint64_t base = 0, long every = 64)
+        : container(container), every(std::max(every, 1L)) {
+        auto begin = container.begin();
+        items = container.end() - begin;
+        checkpoints.reserve(items / this->every + 1);
+        uint64_t sum = base;
+        for (long i = 0; i < items; ++i) {
+            if (i % this->every == 0) {
+                checkpoints.push_back(sum);
+            }
+            sum += uint64_t(begin[i]);
+        }
+        checkpoints.push_back(sum);    // Also covers items == 0
+        total_ = sum;
+    }
+
+    unsigned long size() const { return items; }
+    uint64_t total() const { return total_; }
+
+    // Sum of the first n items, n in [0, size()]
+    uint64_t operator [] (long n) const {
+        if (n >= items) {
+            return total_;
+        }
+        long block = n / every;
+        uint64_t sum = checkpoints[block];
+        auto i = container.begin() + block * every;
+        for (long left = n - block * every; left > 0; --left, ++i) {
+            sum += uint64_t(*i);
+        }
+        return sum;
+    }
+
+    // Item whose span [sum before it, sum after it) contains x, size() if none
+    long find(uint64_t x) const {
+        if (items == 0 || x < checkpoints.front() || x >= total_) {
+            return items;
+        }
+        long block = std::upper_bound(checkpoints.begin(), checkpoints.end() - 1, x) - checkpoints.begin() - 1;
+        uint64_t sum = checkpoints[block];
+        long n = block * every;
+        for (auto i = container.begin() + n; n < items; ++n, ++i) {
+            sum += uint64_t(*i);
+            if (x < sum) {
+                break;
+            }
+        }
+        return n;
+    }
+
+private:
+    Container container;
+    long every;
+    long items;
+    uint64_t total_;
+    std::vector<uint64_t> checkpoints;  // Sum before every `every`th item, plus the total
+};
+
+
+// Run-length encoded tables: runs of entries sharing a value, stored as rows of
+// `stride` items. The length of a run is either a column of its own (stts, ctts:
+// sample_count), or the distance between the first entries of adjacent runs (stsc:
+// first_chunk, where the last run extends up to `entries`).
+template <typename Container>
+struct Runs {
+
+    enum Encoding {
+        counts,
+        starts,
+    };
+
+    struct Layout {
+        long stride = 2;
+        long length = 0;    // Column of the count or of the first entry
+        long value = 1;
+        Encoding encoding = counts;
+        uint64_t entries = 0;   // Total number of entries for starts
+    };
+
+    Runs(const Container &container, Layout layout = Layout(), long every = 64)
+        : container(container), layout(layout), every(std::max(every, 1L)) {
+        runs = (container.end() - container.begin()) / layout.stride;
+        Checkpoint checkpoint;
+        for (long run = 0; run < runs; ++run) {
+            if (run % this->every == 0) {
+                checkpoints.push_back(checkpoint);
+            }
+            auto count = length(run);
+            checkpoint.entries += count;
+            checkpoint.sum += count * value(run);
+        }
+        checkpoints.push_back(checkpoint);
+    }
+
+    uint64_t size() const { return checkpoints.back().entries; }   // Logical entries
+    uint64_t total() const { return checkpoints.back().sum; }      // Sum of all their values
+    long rows() const { return runs; }
+
+    // Value of the nth logical entry, n < size()
+    uint64_t operator [] (uint64_t n) const {
+        return value(locate(n, [](const Checkpoint &c) { return c.entries; }).run);
+    }
+
+    // Sum of the values of the first n logical entries, e.g. decoding time of sample n
+    uint64_t sum(uint64_t n) const {
+        if (n >= size()) {
+            return total();
+        }
+        auto at = locate(n, [](const Checkpoint &c) { return c.entries; });
+        return at.checkpoint.sum + (n - at.checkpoint.entries) * value(at.run);
+    }
+
+    // Logical entry whose span of the running sum contains x, size() if none
+    uint64_t find(uint64_t x) const {
+        if (x >= total()) {
+            return size();
+        }
+        auto at = locate(x, [](const Checkpoint &c) { return c.sum; });
+        return at.checkpoint.entries + (x - at.checkpoint.sum) / value(at.run);
+    }
+
+    // Expands the runs sequentially
+    struct const_iterator {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = long;
+        using reference = uint64_t;
+        using pointer = void;
+
+        const Runs *runs;
+        long run;
+        uint64_t left;  // Entries left in the run
+
+        uint64_t operator * () const { return runs->value(run); }
+        const_iterator &operator ++ () {
+            if (--left == 0) {
+                skip(run + 1);
+            }
+            return *this;
+        }
+        const_iterator operator ++ (int) { auto i = *this; ++*this; return i; }
+        bool operator == (const const_iterator &i) const { return run == i.run && left == i.left; }
+        bool operator != (const const_iterator &i) const { return !(*this == i); }
+
+        void skip(long run) {   // Empty runs have nothing to expand
+            for (; run < runs->runs && runs->length(run) == 0; ++run) {}
+            this->run = run;
+            left = run < runs->runs ? runs->length(run) : 0;
+        }
+    };
+
+    const_iterator begin() const { const_iterator i{this, 0, 0}; i.skip(0); return i; }
+    const_iterator end() const { return const_iterator{this, runs, 0}; }
+
+private:
+    struct Checkpoint {
+        uint64_t entries = 0;   // Before the run
+        uint64_t sum = 0;
+    };
+
+    struct Location {
+        long run;
+        Checkpoint checkpoint;  // At the beginning of the run
+    };
+
+    Container container;
+    Layout layout;
+    long every;
+    long runs;
+    std::vector<Checkpoint> checkpoints;   // Before every `every`th run, plus the totals
+
+    uint64_t item(long run, long column) const {
+        return uint64_t(container.begin()[run * layout.stride + column]);
+    }
+
+    uint64_t value(long run) const {
+        return item(run, layout.value);
+    }
+
+    uint64_t length(long run) const {
+        if (layout.encoding == counts) {
+            return item(run, layout.length);
+        }
+        auto first = item(0, layout.length);
+        auto start = item(run, layout.length) - first;
+        auto next = run + 1 < runs ? item(run + 1, layout.length) - first : layout.entries;
+        return next > start ? next - start : 0;
+    }
+
+    // Run in which key(checkpoint) reaches past x, x < key(totals)
+    template <typename Key>
+    Location locate(uint64_t x, Key key) const {
+        long block = std::upper_bound(checkpoints.begin(), checkpoints.end() - 1, x,
+            [&key](uint64_t x, const Checkpoint &c) { return x < key(c); }) - checkpoints.begin() - 1;
+        Location at{block * every, checkpoints[block]};
+        for (;; ++at.run) {
+            auto count = length(at.run);
+            Checkpoint next{at.checkpoint.entries + count, at.checkpoint.sum + count * value(at.run)};
+            if (x < key(next)) {
+                return at;
+            }
+            at.checkpoint = next;
+        }
+    }
+};
+
+
+template <typename Container>
+PrefixSum<Container> prefix_sum(const Container &container, uint64_t base = 0, long every = 64) {
+    return PrefixSum<Container>(container, base, every);
+}
+
+template <typename Container>
+Runs<Container> runs(const Container &container, typename Runs<Container>::Layout layout = {}, long every = 64) {
+    return Runs<Container>(container, layout, every);
+}
+
+
+}} // namespace bitstream::view
+
+
+#endif // __BITSTREAM_VIEWS_H__
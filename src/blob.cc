@@ -0,0 +1,58 @@
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <unistd.h>
+#include <bitstream/blob.h>
+
+
+namespace bitstream {
+
+
+unsigned long Blob::read_into(char *buffer, unsigned long size, uint64_t offset) const {
+    auto data = this->data();
+    if (data == nullptr) {
+        throw std::runtime_error("Blob is neither resident nor readable");
+    }
+    size = offset < this->size() ? std::min<uint64_t>(size, this->size() - offset) : 0;
+    std::memcpy(buffer, data + offset, size);
+    return size;
+}
+
+uint64_t Blob::read_into(int fd) const {
+    uint64_t written = 0;
+    for (const auto &chunk: chunks()) {
+        for (unsigned long done = 0; done < chunk.size;) {
+            auto n = ::write(fd, chunk.data + done, chunk.size - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+            }
+            done += n;
+        }
+        written += chunk.size;
+    }
+    return written;
+}
+
+
+void Blob::Chunks::load(iterator &it) {
+    auto left = blob.size() - it.offset;
+    if (left == 0) {
+        return;
+    }
+    if (auto data = blob.data()) {
+        it.chunk = Chunk{data + it.offset, (unsigned long)left};
+        return;
+    }
+    buffer.resize(size);
+    it.chunk = Chunk{buffer.data(), blob.read_into(buffer.data(), std::min<uint64_t>(size, left), it.offset)};
+    if (it.chunk.size == 0) {   // Stream ended before the blob did
+        it.offset = blob.size();
+    }
+}
+
+
+} // namespace bitstream
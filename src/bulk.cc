@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <bitstream/machine/bulk.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   include <immintrin.h>
+#   define BITSTREAM_SIMD 1
+#endif
+
+
+namespace bitstream {
+namespace machine {
+namespace bulk {
+
+
+namespace {
+
+ISA detect() {
+#ifdef BITSTREAM_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return avx2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return sse41;
+    }
+#endif
+    return scalar;
+}
+
+bool detect_bmi2() {
+#ifdef BITSTREAM_SIMD
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+// Read on every call and changeable while other threads decode
+ISA supported = detect();
+std::atomic<ISA> current{supported};
+
+bool supported_bmi2 = detect_bmi2();
+std::atomic<bool> current_bmi2{supported_bmi2};
+
+
+// Scalar
+//
+
+template <typename T>
+T bswap(T value);
+
+template <> uint16_t bswap(uint16_t value) { return __builtin_bswap16(value); }
+template <> uint32_t bswap(uint32_t value) { return __builtin_bswap32(value); }
+template <> uint64_t bswap(uint64_t value) { return __builtin_bswap64(value); }
+
+// Byte order of n items of type T is reversed on the way from in to out
+template <typename T>
+void swap_scalar(const char *__restrict in, char *__restrict out, unsigned long n) {
+    for (unsigned long i = 0; i < n; ++i) {
+        T value;
+        std::memcpy(&value, in + i * sizeof(T), sizeof(T));
+        value = bswap(value);
+        std::memcpy(out + i * sizeof(T), &value, sizeof(T));
+    }
+}
+
+void unpack_scalar(const char *data, uint8_t *out, unsigned long n, long bits, Endianness endianness) {
+    const long per_byte = 8 / bits;
+    const uint8_t mask = uint8_t((1 << bits) - 1);
+    const long first = endianness == Endianness::big ? 8 - bits : 0;
+    const long step  = endianness == Endianness::big ? -bits : bits;
+    for (unsigned long i = 0; i < n; ++data) {
+        const uint8_t byte = uint8_t(*data);
+        for (long j = 0, shift = first; j < per_byte && i < n; ++j, ++i, shift += step) {
+            out[i] = (byte >> shift) & mask;
+        }
+    }
+}
+
+void pack_scalar(const uint8_t *in, char *data, unsigned long n, long bits, Endianness endianness) {
+    const long per_byte = 8 / bits;
+    const uint8_t mask = uint8_t((1 << bits) - 1);
+    const long first = endianness == Endianness::big ? 8 - bits : 0;
+    const long step  = endianness == Endianness::big ? -bits : bits;
+    for (unsigned long i = 0; i < n; ++data) {
+        uint8_t byte = 0, written = 0;  // Bits past the last item are kept
+        for (long j = 0, shift = first; j < per_byte && i < n; ++j, ++i, shift += step) {
+            byte |= (in[i] & mask) << shift;
+            written |= mask << shift;
+        }
+        *data = char(byte | (uint8_t(*data) & ~written));
+    }
+}
+
+
+// Any item size up to 16 bits at any bit offset: an item spans at most 3 bytes, so it's
+// in a 32-bit word loaded at its first byte, or read byte by byte at the very end
+template <typename T>
+void unpack_any_scalar(const char *data, T *out, unsigned long n, long bits, Endianness endianness, long offset) {
+    const bool big = endianness == Endianness::big;
+    const uint32_t mask = (uint32_t(1) << bits) - 1;
+    const unsigned long bytes = (offset + n * bits + 7) / 8;
+    unsigned long i = 0, bit = offset;
+    for (; i < n && bit / 8 + sizeof(uint32_t) <= bytes; ++i, bit += bits) {
+        uint32_t word;
+        std::memcpy(&word, data + bit / 8, sizeof(word));
+        word = big ? __builtin_bswap32(word) >> (32 - bit % 8 - bits) : word >> bit % 8;
+        out[i] = T(word & mask);
+    }
+    for (; i < n; ++i, bit += bits) {
+        const uint8_t *at = reinterpret_cast<const uint8_t *>(data) + bit / 8;
+        const long lbits = bit % 8, span = (lbits + bits + 7) / 8;
+        uint32_t word = 0;
+        for (long j = 0; j < span; ++j) {
+            word |= uint32_t(at[j]) << 8 * (big ? span - 1 - j : j);
+        }
+        out[i] = T((word >> (big ? 8 * span - lbits - bits : lbits)) & mask);
+    }
+}
+
+// Byte by byte, overlapping word stores of consecutive items would stall on store forwarding
+template <typename T>
+void pack_any_scalar(const T *in, char *data, unsigned long n, long bits, Endianness endianness, long offset) {
+    const bool big = endianness == Endianness::big;
+    const uint32_t mask = (uint32_t(1) << bits) - 1;
+    for (unsigned long i = 0, bit = offset; i < n; ++i, bit += bits) {
+        uint8_t *at = reinterpret_cast<uint8_t *>(data) + bit / 8;
+        const long lbits = bit % 8, span = (lbits + bits + 7) / 8;
+        const long shift = big ? 8 * span - lbits - bits : lbits;
+        const uint32_t value = (uint32_t(in[i]) & mask) << shift, written = mask << shift;
+        for (long j = 0; j < span; ++j) {
+            const long k = big ? span - 1 - j : j;
+            at[j] = uint8_t((at[j] & ~(written >> 8 * k)) | (value >> 8 * k));
+        }
+    }
+}
+
+
+long find_scalar(const char *data, unsigned long n, char ch, long bits) {
+    for (unsigned long i = 0; i < n; ++i) {
+        if (char(uint8_t(data[i]) << bits | uint8_t(data[i + 1]) >> (8 - bits)) == ch) {
+            return i;
+        }
+    }
+    return n;
+}
+
+
+#ifdef BITSTREAM_SIMD
+
+// Byte reversal within every item of a 16 byte lane
+template <typename T>
+__attribute__((target("sse4.1")))
+__m128i reversal() {
+    alignas(16) int8_t order[16];
+    for (int i = 0; i < 16; ++i) {
+        order[i] = int8_t(i / sizeof(T) * sizeof(T) + sizeof(T) - 1 - i % sizeof(T));
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(order));
+}
+
+template <typename T>
+__attribute__((target("sse4.1")))
+void swap_sse41(const char *in, char *out, unsigned long n) {
+    const __m128i order = reversal<T>();
+    const unsigned long bytes = n * sizeof(T);
+    unsigned long i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(v, order));
+    }
+    swap_scalar<T>(in + i, out + i, (bytes - i) / sizeof(T));
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+void swap_avx2(const char *in, char *out, unsigned long n) {
+    const __m256i order = _mm256_broadcastsi128_si256(reversal<T>());
+    const unsigned long bytes = n * sizeof(T);
+    unsigned long i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_shuffle_epi8(v, order));
+    }
+    swap_scalar<T>(in + i, out + i, (bytes - i) / sizeof(T));
+}
+
+// 16 bytes in, 16 * 8 / bits items out per step
+__attribute__((target("sse4.1")))
+void unpack_sse41(const char *data, uint8_t *out, unsigned long n, long bits, Endianness endianness) {
+    const bool big = endianness == Endianness::big;
+    const unsigned long per_vector = 16 * 8 / bits;
+    const __m128i mask = _mm_set1_epi8(char((1 << bits) - 1));
+    unsigned long i = 0;
+    for (; i + per_vector <= n; i += per_vector) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * bits / 8));
+        __m128i *o = reinterpret_cast<__m128i *>(out + i);
+        if (bits == 4) {
+            __m128i h = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+            __m128i l = _mm_and_si128(v, mask);
+            __m128i first = big ? h : l, second = big ? l : h;
+            _mm_storeu_si128(o + 0, _mm_unpacklo_epi8(first, second));
+            _mm_storeu_si128(o + 1, _mm_unpackhi_epi8(first, second));
+        } else if (bits == 2) {
+            __m128i q[4] = {
+                _mm_and_si128(v, mask),
+                _mm_and_si128(_mm_srli_epi16(v, 2), mask),
+                _mm_and_si128(_mm_srli_epi16(v, 4), mask),
+                _mm_and_si128(_mm_srli_epi16(v, 6), mask),
+            };
+            if (big) {
+                std::swap(q[0], q[3]);
+                std::swap(q[1], q[2]);
+            }
+            __m128i lo01 = _mm_unpacklo_epi8(q[0], q[1]), hi01 = _mm_unpackhi_epi8(q[0], q[1]);
+            __m128i lo23 = _mm_unpacklo_epi8(q[2], q[3]), hi23 = _mm_unpackhi_epi8(q[2], q[3]);
+            _mm_storeu_si128(o + 0, _mm_unpacklo_epi16(lo01, lo23));
+            _mm_storeu_si128(o + 1, _mm_unpackhi_epi16(lo01, lo23));
+            _mm_storeu_si128(o + 2, _mm_unpacklo_epi16(hi01, hi23));
+            _mm_storeu_si128(o + 3, _mm_unpackhi_epi16(hi01, hi23));
+        } else {
+            // Every byte is spread over 8 lanes, each of which tests its own bit
+            const __m128i select = big
+                ? _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128)
+                : _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+            const __m128i one = _mm_set1_epi8(1);
+            __m128i spread = _mm_set_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+            for (int k = 0; k < 8; ++k) {
+                __m128i b = _mm_and_si128(_mm_shuffle_epi8(v, spread), select);
+                _mm_storeu_si128(o + k, _mm_and_si128(_mm_cmpeq_epi8(b, select), one));
+                spread = _mm_add_epi8(spread, _mm_set1_epi8(2));
+            }
+        }
+    }
+    unpack_scalar(data + i * bits / 8, out + i, n - i, bits, endianness);
+}
+
+// Adjacent items are merged pairwise (multiply-add) until 8 bits wide, 16 bytes out per step
+__attribute__((target("sse4.1")))
+void pack_sse41(const uint8_t *in, char *data, unsigned long n, long bits, Endianness endianness) {
+    const bool big = endianness == Endianness::big;
+    const long vectors = 8 / bits;
+    const unsigned long per_vector = 16 * vectors;
+    const __m128i mask = _mm_set1_epi8(char((1 << bits) - 1));
+    unsigned long i = 0;
+    for (; i + per_vector <= n; i += per_vector) {
+        __m128i v[8];
+        for (long k = 0; k < vectors; ++k) {
+            v[k] = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 16 * k)), mask);
+        }
+        for (long width = bits, count = vectors; width < 8; width *= 2, count /= 2) {
+            const __m128i weights = big
+                ? _mm_set1_epi16(short((1 << width) | 0x0100))  // first << width | second
+                : _mm_set1_epi16(short(1 | (1 << width) << 8));   // first | second << width
+            for (long k = 0; k < count / 2; ++k) {
+                v[k] = _mm_packus_epi16(
+                    _mm_maddubs_epi16(v[2 * k], weights),
+                    _mm_maddubs_epi16(v[2 * k + 1], weights));
+            }
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(data + i * bits / 8), v[0]);
+    }
+    pack_scalar(in + i, data + i * bits / 8, n - i, bits, endianness);
+}
+
+// Bytes are realigned from two overlapping loads, 16 per step
+__attribute__((target("sse4.1")))
+long find_sse41(const char *data, unsigned long n, char ch, long bits) {
+    const __m128i needle = _mm_set1_epi8(ch);
+    const __m128i high = _mm_set1_epi8(char(0xFF << bits));
+    const __m128i low = _mm_set1_epi8(char(0xFF >> (8 - bits)));
+    const __m128i left = _mm_cvtsi32_si128(int(bits)), right = _mm_cvtsi32_si128(int(8 - bits));
+    unsigned long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 1));
+        __m128i v = _mm_or_si128(
+            _mm_and_si128(_mm_sll_epi16(a, left), high),
+            _mm_and_si128(_mm_srl_epi16(b, right), low));
+        int found = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+        if (found) {
+            return i + __builtin_ctz(found);
+        }
+    }
+    return i + find_scalar(data + i, n - i, ch, bits);
+}
+
+
+// Groups of items are loaded as one (up to 57 bits) little endian or big endian
+// number, PDEP spreads them over the lanes of a 64-bit word, PEXT gathers them
+// back. Big endian items come most significant first, so their lanes are reversed.
+template <typename T>
+struct Lanes {
+    static constexpr long count = 8 / sizeof(T);
+
+    long items;         // Per group
+    uint64_t mask;      // Low bits of each of the items lanes
+
+    Lanes(long bits) : items(std::min(count, 57 / bits)), mask(0) {
+        for (long j = 0; j < items; ++j) {
+            mask |= ((uint64_t(1) << bits) - 1) << 8 * sizeof(T) * j;
+        }
+    }
+
+    // First of the items goes to the first lane and back
+    static uint64_t reverse(uint64_t lanes, long items) {
+        lanes = __builtin_bswap64(lanes);
+        if (sizeof(T) == 2) {
+            lanes = (lanes >> 8 & 0x00FF00FF00FF00FFULL) | (lanes & 0x00FF00FF00FF00FFULL) << 8;
+        }
+        return lanes >> 8 * sizeof(T) * (count - items);
+    }
+};
+
+inline uint64_t load(const char *data) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    return word;
+}
+
+inline void store(char *data, uint64_t word) {
+    std::memcpy(data, &word, sizeof(word));
+}
+
+template <typename T>
+__attribute__((target("bmi2")))
+void unpack_bmi2(const char *data, T *out, unsigned long n, long bits, Endianness endianness, long offset) {
+    const bool big = endianness == Endianness::big;
+    const Lanes<T> lanes(bits);
+    const unsigned long bytes = (offset + n * bits + 7) / 8;    // Neither read nor written past these
+    const long group = lanes.items * bits;
+    unsigned long i = 0, bit = offset;
+    for (; i + Lanes<T>::count <= n && bit / 8 + 8 <= bytes; i += lanes.items, bit += group) {
+        uint64_t word = load(data + bit / 8);
+        uint64_t items;
+        if (big) {
+            items = _pdep_u64(__builtin_bswap64(word) >> (64 - bit % 8 - group), lanes.mask);
+            items = Lanes<T>::reverse(items, lanes.items);
+        } else {
+            items = _pdep_u64(word >> bit % 8, lanes.mask);
+        }
+        store(reinterpret_cast<char *>(out + i), items);
+    }
+    unpack_any_scalar(data + bit / 8, out + i, n - i, bits, endianness, bit % 8);
+}
+
+template <typename T>
+__attribute__((target("bmi2")))
+void pack_bmi2(const T *in, char *data, unsigned long n, long bits, Endianness endianness, long offset) {
+    const bool big = endianness == Endianness::big;
+    const Lanes<T> lanes(bits);
+    const unsigned long bytes = (offset + n * bits + 7) / 8;
+    const long group = lanes.items * bits;
+    const uint64_t written = (uint64_t(1) << group) - 1;
+    unsigned long i = 0, bit = offset;
+    for (; i + Lanes<T>::count <= n && bit / 8 + 8 <= bytes; i += lanes.items, bit += group) {
+        uint64_t items = load(reinterpret_cast<const char *>(in + i));
+        uint64_t word = load(data + bit / 8);
+        if (big) {
+            const long shift = 64 - bit % 8 - group;
+            items = _pext_u64(Lanes<T>::reverse(items, lanes.items), lanes.mask);
+            word = __builtin_bswap64(word);
+            word = (word & ~(written << shift)) | items << shift;
+            word = __builtin_bswap64(word);
+        } else {
+            items = _pext_u64(items, lanes.mask);
+            word = (word & ~(written << bit % 8)) | items << bit % 8;
+        }
+        store(data + bit / 8, word);
+    }
+    pack_any_scalar(in + i, data + bit / 8, n - i, bits, endianness, bit % 8);
+}
+
+#endif
+
+} // namespace
+
+
+ISA isa() {
+    return current.load(std::memory_order_relaxed);
+}
+
+ISA isa(ISA limit) {
+    return current.exchange(limit < supported ? limit : supported, std::memory_order_relaxed);
+}
+
+bool bmi2() {
+    return current_bmi2.load(std::memory_order_relaxed);
+}
+
+bool bmi2(bool use) {
+    return current_bmi2.exchange(use && supported_bmi2, std::memory_order_relaxed);
+}
+
+template <typename T>
+static void swap_dispatch(const char *in, char *out, unsigned long n) {
+#ifdef BITSTREAM_SIMD
+    switch (isa()) {
+    case avx2:  return swap_avx2<T>(in, out, n);
+    case sse41: return swap_sse41<T>(in, out, n);
+    default: break;
+    }
+#endif
+    swap_scalar<T>(in, out, n);
+}
+
+void swap(const char *data, uint16_t *out, unsigned long n) { swap_dispatch<uint16_t>(data, reinterpret_cast<char *>(out), n); }
+void swap(const char *data, uint32_t *out, unsigned long n) { swap_dispatch<uint32_t>(data, reinterpret_cast<char *>(out), n); }
+void swap(const char *data, uint64_t *out, unsigned long n) { swap_dispatch<uint64_t>(data, reinterpret_cast<char *>(out), n); }
+
+void swap(const uint16_t *in, char *data, unsigned long n) { swap_dispatch<uint16_t>(reinterpret_cast<const char *>(in), data, n); }
+void swap(const uint32_t *in, char *data, unsigned long n) { swap_dispatch<uint32_t>(reinterpret_cast<const char *>(in), data, n); }
+void swap(const uint64_t *in, char *data, unsigned long n) { swap_dispatch<uint64_t>(reinterpret_cast<const char *>(in), data, n); }
+
+void unpack(const char *data, uint8_t *out, unsigned long n, long bits, Endianness endianness) {
+#ifdef BITSTREAM_SIMD
+    if (isa() >= sse41) {
+        return unpack_sse41(data, out, n, bits, endianness);
+    }
+#endif
+    unpack_scalar(data, out, n, bits, endianness);
+}
+
+long find(const char *data, unsigned long n, char ch, long bits) {
+    if (bits == 0) {
+        auto found = static_cast<const char *>(std::memchr(data, ch, n));
+        return found ? found - data : n;
+    }
+#ifdef BITSTREAM_SIMD
+    if (isa() >= sse41) {
+        return find_sse41(data, n, ch, bits);
+    }
+#endif
+    return find_scalar(data, n, ch, bits);
+}
+
+void pack(const uint8_t *in, char *data, unsigned long n, long bits, Endianness endianness) {
+#ifdef BITSTREAM_SIMD
+    if (isa() >= sse41) {
+        return pack_sse41(in, data, n, bits, endianness);
+    }
+#endif
+    pack_scalar(in, data, n, bits, endianness);
+}
+
+
+template <typename T>
+static void unpack_dispatch(const char *data, T *out, unsigned long n, long bits, Endianness endianness, long offset) {
+#ifdef BITSTREAM_SIMD
+    if (bmi2()) {
+        return unpack_bmi2(data, out, n, bits, endianness, offset);
+    }
+#endif
+    unpack_any_scalar(data, out, n, bits, endianness, offset);
+}
+
+template <typename T>
+static void pack_dispatch(const T *in, char *data, unsigned long n, long bits, Endianness endianness, long offset) {
+#ifdef BITSTREAM_SIMD
+    if (bmi2()) {
+        return pack_bmi2(in, data, n, bits, endianness, offset);
+    }
+#endif
+    pack_any_scalar(in, data, n, bits, endianness, offset);
+}
+
+void unpack(const char *data, uint8_t  *out, unsigned long n, long bits, Endianness endianness, long offset) { unpack_dispatch(data, out, n, bits, endianness, offset); }
+void unpack(const char *data, uint16_t *out, unsigned long n, long bits, Endianness endianness, long offset) { unpack_dispatch(data, out, n, bits, endianness, offset); }
+void pack(const uint8_t  *in, char *data, unsigned long n, long bits, Endianness endianness, long offset) { pack_dispatch(in, data, n, bits, endianness, offset); }
+void pack(const uint16_t *in, char *data, unsigned long n, long bits, Endianness endianness, long offset) { pack_dispatch(in, data, n, bits, endianness, offset); }
+
+}}} // namespace bitstream::machine::bulk
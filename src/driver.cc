@@ -0,0 +1,72 @@
+#include <bitstream/ifstream.h>
+#include <bitstream/pool.h>
+#include <bitstream/driver.h>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+double Driver::Summary::throughput() const {
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? bytes / seconds : 0;
+}
+
+double Driver::Summary::files_per_second() const {
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? results.size() / seconds : 0;
+}
+
+
+Driver::Driver(ParserFactory parser, ObserverFactory observer, unsigned threads, unsigned long queue)
+    : parser(parser), observer(observer), threads(threads), queue(queue) {
+    stream = [](const std::string &path) {
+        return std::unique_ptr<bitstream::Stream>(new input::file::Stream(path));
+    };
+}
+
+Driver::Summary Driver::run(const std::vector<std::string> &paths) const {
+    Summary summary;
+    summary.results.resize(paths.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        Pool pool(threads, queue);
+        for (unsigned long i = 0; i < paths.size(); ++i) {
+            pool.submit([this, &paths, &summary, i] {
+                parse(paths[i], summary.results[i]);
+            });
+        }
+        pool.wait();
+    }
+    summary.elapsed = std::chrono::steady_clock::now() - start;
+    for (const auto &result: summary.results) {
+        summary.bytes += result.bytes;
+        summary.failed += result.exception ? 1 : 0;
+    }
+    return summary;
+}
+
+void Driver::parse(const std::string &path, Result &result) const {
+    auto start = std::chrono::steady_clock::now();
+    result.path = path;
+    try {
+        auto stream = this->stream(path);
+        result.observer = observer(path);
+        auto parser = this->parser(*stream, *result.observer);
+        try {
+            parser->parse();
+        } catch (...) {
+            result.exception = std::current_exception();
+            Parser::Event::Exception{*parser};
+        }
+        result.bytes = stream->offset();
+    } catch (...) {
+        if (!result.exception) {
+            result.exception = std::current_exception();
+        }
+    }
+    result.duration = std::chrono::steady_clock::now() - start;
+}
+
+
+}} // namespace bitstream::parallel
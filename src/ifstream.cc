@@ -1,6 +1,13 @@
-#include <cassert>
 #include <cerrno>
+#include <cstdlib>
+#include <memory>
 #include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
 #include <bitstream/sstream.h>
 #include <bitstream/ifstream.h>
 
@@ -12,9 +19,11 @@ namespace file {
 
 
 const char *Stream::peak(unsigned long size) {
+    buffer.statistics.largest_peak = std::max(buffer.statistics.largest_peak, size);
     if (buffer.data.size < size) {
-        buffer.defragment();
-        buffer.data.size += file.read(buffer.begin + buffer.data.end(), file.offset + buffer.data.size, buffer.can_read(size));
+        buffer.defragment(file.direct ? file.offset % buffer.block.size : 0);
+        buffer.data.size += read(buffer.begin + buffer.data.end(), file.offset + buffer.data.size, buffer.can_read(size));
+        buffer.statistics.high_water_mark = std::max(buffer.statistics.high_water_mark, buffer.data.size);
         if (buffer.data.size < size) {
             throw EndOfStream(file.path + ": end of stream");
         }
@@ -25,71 +34,273 @@ const char *Stream::peak(unsigned long size) {
 Blob &Stream::peak_blob(unsigned long size) {
     blob._offset = file.offset;
     blob._size = size;
+    blob._data = size <= buffer.data.size ? buffer.begin + buffer.data.offset : nullptr;
     return blob;
 }
 
 Blob &Stream::get_blob(unsigned long size) {
-    blob._offset = file.offset;
-    blob._size = size;
+    peak_blob(size);
     buffer.data -= std::min(size, buffer.data.size);
     file.offset += size;
     return blob;
 }
 
-
-
-Stream::fstream::fstream(const std::string &path) : path(path) {
-    rdbuf()->pubsetbuf(nullptr, 0); // No internal buffering
-    open(path);
-    if (!is_open()) {
-        throw std::runtime_error(path + ": " + std::strerror(errno));
+unsigned long Stream::Blob_::read_into(char *buffer, unsigned long size, uint64_t offset) const {
+    if (offset >= _size) {
+        return 0;
+    }
+    size = std::min<uint64_t>(size, _size - offset);
+    if (_data != nullptr) {
+        std::memcpy(buffer, _data + offset, size);
+        return size;
     }
+    return file->copy(buffer, _offset + offset, size);
 }
 
-unsigned long Stream::fstream::read(char *data, uint64_t offset, unsigned long size) {
-    assert(eof() || tellg() <= offset); // Make sure it never goes backward
-    seekg(offset);
-    std::ifstream::read(data, size);
-    return gcount();
+uint64_t Stream::Blob_::read_into(int fd) const {
+    if (_data == nullptr && !file->direct) {   // Let kernel copy it without passing through user space
+        loff_t offset = _offset;
+        uint64_t done = 0;
+        while (done < _size) {
+            auto n = ::copy_file_range(file->fd, &offset, fd, nullptr, _size - done, 0);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                } else if (done == 0) {
+                    break;  // Not supported for these descriptors, fall back to read & write
+                }
+                throw std::runtime_error(file->path + ": " + std::strerror(errno));
+            } else if (n == 0) {
+                return done;    // End of file
+            }
+            done += n;
+        }
+        if (done != 0 || _size == 0) {
+            return done;
+        }
+    }
+    return bitstream::Blob::read_into(fd);
 }
 
 
 
 namespace {
-unsigned long block_size() {
-    // TODO: find out real block size
-    // Think. It sould be specific per device?
+unsigned long block_size(int fd, bool direct) {
+#ifdef STATX_DIOALIGN
+    struct statx stx;
+    if (direct && ::statx(fd, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 &&
+            (stx.stx_mask & STATX_DIOALIGN) && stx.stx_dio_offset_align != 0) {
+        return std::max(stx.stx_dio_offset_align, stx.stx_dio_mem_align);
+    }
+#endif
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        if (S_ISBLK(st.st_mode)) {
+            int size;
+            if (::ioctl(fd, BLKSSZGET, &size) == 0 && size > 0) {
+                return std::max<unsigned long>(size, direct ? 0 : st.st_blksize);
+            }
+        }
+        if (st.st_blksize > 0) {    // Preferred IO size is a multiple of logical block size
+            return st.st_blksize;
+        }
+    }
     return 512;
 }}
 
-Stream::Buffer::Block::Block() {
-    static unsigned long size = block_size();
-    this->size = size;
+Stream::fstream::fstream(const std::string &path, bool direct) : path(path), direct(direct) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | (direct ? O_DIRECT : 0));
+    if (fd == -1 && direct && errno == EINVAL) {    // File system doesn't support direct IO
+        this->direct = false;
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd == -1) {
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    }
+    block_size = bitstream::input::file::block_size(fd, this->direct);
 }
 
+Stream::fstream::~fstream() {
+    ::close(fd);
+}
 
+unsigned long Stream::fstream::read(char *data, uint64_t offset, unsigned long size) {
+    // Direct reads start at the block boundary, buffer is laid out the same way
+    auto skew = direct ? offset % block_size : 0;
+    auto length = direct ? (size + skew + block_size - 1) / block_size * block_size : size;
+    unsigned long done = 0;
+    while (done < length) {
+        auto n = ::pread(fd, data - skew + done, length - done, offset - skew + done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        } else if (n == 0) {
+            break;
+        }
+        done += n;
+    }
+    return done > skew ? std::min(done - skew, size) : 0;
+}
 
-Stream::Buffer::Buffer(unsigned long size) {
+unsigned long Stream::fstream::copy(char *data, uint64_t offset, unsigned long size) const {
+    if (!direct) {
+        unsigned long done = 0;
+        while (done < size) {
+            auto n = ::pread(fd, data + done, size - done, offset + done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(path + ": " + std::strerror(errno));
+            } else if (n == 0) {
+                break;
+            }
+            done += n;
+        }
+        return done;
+    }
+    // Direct IO needs aligned memory, offset and size, so it goes through a bounce buffer
+    auto chunk = std::max(block_size, 64 * 1024UL) / block_size * block_size;
+    std::unique_ptr<char, decltype(&std::free)> bounce(static_cast<char *>(std::aligned_alloc(block_size, chunk)), &std::free);
+    if (!bounce) {
+        throw std::bad_alloc();
+    }
+    unsigned long done = 0;
+    while (done < size) {
+        auto skew = (offset + done) % block_size;
+        auto n = ::pread(fd, bounce.get(), chunk, offset + done - skew);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        } else if ((unsigned long)n <= skew) {
+            break;
+        }
+        auto copied = std::min<unsigned long>(n - skew, size - done);
+        std::memcpy(data + done, bounce.get() + skew, copied);
+        done += copied;
+    }
+    return done;
+}
+
+
+
+char *Stream::mirrored(unsigned long size) {
+    int fd = ::memfd_create("bitstream", MFD_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error(std::string("memfd_create: ") + std::strerror(errno));
+    }
+    if (::ftruncate(fd, size) == -1) {
+        auto error = errno;
+        ::close(fd);
+        throw std::runtime_error(std::string("ftruncate: ") + std::strerror(error));
+    }
+    // Reserve a contiguous range then map the same pages twice into it
+    void *begin = ::mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (begin == MAP_FAILED ||
+            ::mmap(begin, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            ::mmap(static_cast<char *>(begin) + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        auto error = errno;
+        if (begin != MAP_FAILED) {
+            ::munmap(begin, 2 * size);
+        }
+        ::close(fd);
+        throw std::runtime_error(std::string("mmap: ") + std::strerror(error));
+    }
+    ::close(fd);    // Mappings keep the memory alive
+    return static_cast<char *>(begin);
+}
+
+Stream::Buffer::Buffer(unsigned long size, unsigned long block_size, bool ring, bool aligned, unsigned long limit)
+    : ring(ring), aligned(aligned) {
+    block.size = block_size;
+    if (ring) {     // Both halves have to be page aligned
+        block.size = std::max(block.size, (unsigned long)::sysconf(_SC_PAGESIZE));
+    }
     // Make sure that size has at least 2 blocks and is multiple of block.size
     size = std::max(size, (size / block.size + (size % block.size ? 1: 0)) * block.size);    // Floor
     size = std::max(size, 2 * block.size);
-    begin = new char[size];
+    begin = allocate(size);
     this->size = size;
+    this->limit = std::max(size, limit / block.size * block.size);
 }
 
 Stream::Buffer::~Buffer() {
-    delete [] begin;
+    release(begin, size);
+}
+
+char *Stream::Buffer::allocate(unsigned long size) const {
+    if (ring) {
+        return mirrored(size);
+    }
+    auto begin = static_cast<char *>(std::aligned_alloc(block.size, size));
+    if (begin == nullptr) {
+        throw std::bad_alloc();
+    }
+    return begin;
 }
 
-void Stream::Buffer::defragment() {
-    // Move leftover to the begin of buffer
-    ::memcpy((void *)begin, begin + data.offset, data.size);
-    data.offset = 0;
+void Stream::Buffer::release(char *begin, unsigned long size) const {
+    if (ring) {
+        ::munmap(begin, 2 * size);
+    } else {
+        std::free(begin);
+    }
+}
+
+void Stream::Buffer::grow(unsigned long size) {
+    auto grown = this->size;
+    while (grown < size && grown < limit) {
+        grown *= 2;
+    }
+    grown = std::min(grown, limit);
+    if (grown == this->size) {
+        return;
+    }
+    // Unread data keeps its offset within a block, aligned reads rely on it
+    auto begin = allocate(grown);
+    auto offset = data.offset % block.size;
+    ::memcpy(begin + offset, this->begin + data.offset, data.size);
+    release(this->begin, this->size);
+    this->begin = begin;
+    this->size = grown;
+    data.offset = offset;
+    ++statistics.reallocations;
+}
+
+void Stream::Buffer::defragment(unsigned long alignment) {
+    if (ring) {
+        // Nothing to move, just keep the window within the first mapping
+        if (data.size == 0) {
+            data.offset = alignment;
+        } else if (data.offset >= size) {
+            data.offset -= size;
+        }
+        return;
+    }
+    // Move leftover to the begin of buffer (keeping its offset within a block if requested)
+    ::memmove((void *)(begin + alignment), begin + data.offset, data.size);
+    data.offset = alignment;
+}
+
+unsigned long Stream::Buffer::capacity() const {
+    auto limit = ring ? data.offset + size : size;
+    if (aligned) {
+        limit = limit / block.size * block.size;
+    }
+    return limit > data.end() ? limit - data.end() : 0;
 }
 
 unsigned long Stream::Buffer::can_read(unsigned long size) {
     auto required = size - data.size;
     auto capacity = this->capacity();
+    if (capacity < required && this->size < limit) {
+        grow(data.offset % block.size + size + (aligned ? block.size : 0));
+        capacity = this->capacity();
+    }
     if (capacity < required) {
         throw std::runtime_error(SStream() << "Couldn't ensure size of " << size << " bytes which more than capacity of " << capacity << " bytes allows (" << data.size << " bytes already in buffer). The entire buffer should have had more capacity!!!");
     }
@@ -99,4 +310,3 @@ unsigned long Stream::Buffer::can_read(unsigned long size) {
 
 
 }}} // namespace bitstream::input::file
-
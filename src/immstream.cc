@@ -0,0 +1,55 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <bitstream/immstream.h>
+
+
+namespace bitstream {
+namespace input {
+namespace mmap {
+
+
+Stream::Stream(const std::string &path, Access access) : memory::Stream(path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error(path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+        auto error = errno;
+        ::close(fd);
+        throw std::runtime_error(path + ": " + std::strerror(error));
+    }
+    size_ = st.st_size;
+    if (size_ != 0) {   // Zero length mapping is not allowed
+        void *begin = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (begin == MAP_FAILED) {
+            auto error = errno;
+            ::close(fd);
+            throw std::runtime_error(path + ": " + std::strerror(error));
+        }
+        begin_ = static_cast<const char *>(begin);
+    }
+    ::close(fd);    // Mapping keeps its own reference to the file
+    advise(access);
+}
+
+Stream::~Stream() {
+    if (begin_ != nullptr) {
+        ::munmap(const_cast<char *>(begin_), size_);
+    }
+}
+
+void Stream::advise(Access access) {
+    if (begin_ == nullptr) {
+        return;
+    }
+    static const int advices[] = { MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM };
+    ::madvise(const_cast<char *>(begin_), size_, advices[access]); // Only a hint, failure is harmless
+}
+
+}}} // namespace bitstream::input::mmap
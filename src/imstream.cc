@@ -0,0 +1,38 @@
+#include <cstring>
+#include <algorithm>
+#include <bitstream/imstream.h>
+
+
+namespace bitstream {
+namespace input {
+namespace memory {
+
+
+const char *Stream::peak(unsigned long size) {
+    if (offset_ > size_ || size_ - offset_ < size) {
+        throw EndOfStream(name + ": end of stream");
+    }
+    return begin_ + offset_;
+}
+
+Stream::Blob &Stream::peak_blob(unsigned long size) {
+    blob._data = begin_ + std::min(offset_, size_);
+    blob._size = size;
+    blob._resident = std::min<uint64_t>(size, size_ - std::min(offset_, size_));
+    return blob;
+}
+
+Stream::Blob &Stream::get_blob(unsigned long size) {
+    peak_blob(size);
+    offset_ += size;
+    return blob;
+}
+
+unsigned long Stream::Blob::read_into(char *buffer, unsigned long size, uint64_t offset) const {
+    size = offset < _resident ? std::min<uint64_t>(size, _resident - offset) : 0;
+    std::memcpy(buffer, _data + offset, size);
+    return size;
+}
+
+
+}}} // namespace bitstream::input::memory
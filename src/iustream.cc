@@ -0,0 +1,357 @@
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <bitstream/sstream.h>
+#include <bitstream/iustream.h>
+
+#if __has_include(<linux/io_uring.h>)
+#   include <linux/io_uring.h>
+#   define BITSTREAM_IO_URING 1
+#endif
+
+
+namespace bitstream {
+namespace input {
+namespace uring {
+
+
+namespace {
+
+#ifdef BITSTREAM_IO_URING
+
+// Bare minimum of io_uring needed to keep vectored reads in flight
+struct Ring {
+
+    Ring(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd = int(::syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return;
+        }
+
+        sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_size = cq_size = std::max(sq_size, cq_size);
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        sq = map(sq_size, IORING_OFF_SQ_RING);
+        cq = single_mmap ? sq : map(cq_size, IORING_OFF_CQ_RING);
+        auto sqes = map(sqes_size, IORING_OFF_SQES);
+        if (sq == MAP_FAILED || cq == MAP_FAILED || sqes == MAP_FAILED) {
+            release();
+            return;
+        }
+        this->sqes = static_cast<io_uring_sqe *>(sqes);
+
+        sq_head  = at<unsigned>(sq, params.sq_off.head);
+        sq_tail  = at<unsigned>(sq, params.sq_off.tail);
+        sq_mask  = *at<unsigned>(sq, params.sq_off.ring_mask);
+        sq_array = at<unsigned>(sq, params.sq_off.array);
+        cq_head  = at<unsigned>(cq, params.cq_off.head);
+        cq_tail  = at<unsigned>(cq, params.cq_off.tail);
+        cq_mask  = *at<unsigned>(cq, params.cq_off.ring_mask);
+        cqes     = at<io_uring_cqe>(cq, params.cq_off.cqes);
+    }
+
+    ~Ring() { release(); }
+
+    bool available() const { return fd >= 0; }
+
+    void readv(int file, const iovec *iov, uint64_t offset, uint64_t user_data) {
+        unsigned tail = *sq_tail;
+        unsigned index = tail & sq_mask;
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_READV;
+        sqe.fd = file;
+        sqe.addr = reinterpret_cast<uint64_t>(iov);
+        sqe.len = 1;
+        sqe.off = offset;
+        sqe.user_data = user_data;
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+        while (enter(1, 0, 0) < 0) {
+            if (errno != EINTR) {
+                throw std::runtime_error(std::string("io_uring: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    // Blocks until at least one completion is available and hands all of them over
+    template <typename lambda>
+    void complete(lambda completed) {
+        unsigned head = *cq_head;
+        while (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                throw std::runtime_error(std::string("io_uring: ") + std::strerror(errno));
+            }
+        }
+        for (; head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE); ++head) {
+            const io_uring_cqe &cqe = cqes[head & cq_mask];
+            completed(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+
+private:
+    int fd = -1;
+    bool single_mmap = false;
+    void *sq = MAP_FAILED, *cq = MAP_FAILED;
+    size_t sq_size = 0, cq_size = 0, sqes_size = 0;
+
+    io_uring_sqe *sqes = nullptr;
+    unsigned *sq_head, *sq_tail, *sq_array, sq_mask;
+    unsigned *cq_head, *cq_tail, cq_mask;
+    io_uring_cqe *cqes;
+
+    template <typename T>
+    static T *at(void *base, unsigned offset) {
+        return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+    }
+
+    void *map(size_t size, off_t offset) {
+        return ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return int(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    void release() {
+        if (sqes != nullptr) {
+            ::munmap(sqes, sqes_size);
+            sqes = nullptr;
+        }
+        if (cq != MAP_FAILED && !single_mmap) {
+            ::munmap(cq, cq_size);
+        }
+        if (sq != MAP_FAILED) {
+            ::munmap(sq, sq_size);
+        }
+        sq = cq = MAP_FAILED;
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+};
+
+#else
+
+struct Ring {
+    Ring(unsigned) {}
+    bool available() const { return false; }
+    void readv(int, const iovec *, uint64_t, uint64_t) {}
+    template <typename lambda>
+    void complete(lambda) {}
+};
+
+#endif
+
+} // namespace
+
+
+
+struct Stream::ReadAhead {
+
+    ReadAhead(int fd, const std::string &path, unsigned long depth, unsigned long chunk);
+    ~ReadAhead();
+
+    // Makes [offset, offset + size) resident unless the end of file comes first
+    void fill(uint64_t offset, unsigned long size);
+    const char *at(uint64_t offset) const { return window + (offset - head * chunk); }
+
+    int fd;
+    const std::string &path;
+    unsigned long chunk;
+    Ring ring;
+    uint64_t ready = 0;     // [head * chunk, ready) is resident
+
+private:
+    struct Slot {
+        enum State {
+            idle,
+            advised,    // Synchronous fallback: kernel is asked to read ahead, pread happens on wait
+            submitted,  // Read is in flight
+            resident,
+        } state = idle;
+        char *data = nullptr;
+        long size = 0;          // Bytes read (or negative errno)
+        iovec iov;
+    };
+    std::vector<Slot> slots;
+    char *buffer;                   // Slots back to back, mapped twice so that any window is contiguous
+    const char *window;             // Where the head chunk starts
+    uint64_t head = 0, next = 0;    // Chunks [head, next) are either in flight or resident
+
+    Slot &slot(uint64_t index) { return slots[index % slots.size()]; }
+
+    void submit(uint64_t index);
+    void complete();
+    void retire(uint64_t index);
+    Slot &wait(uint64_t index);
+    void restart(uint64_t index);
+};
+
+
+Stream::ReadAhead::ReadAhead(int fd, const std::string &path, unsigned long depth, unsigned long chunk)
+    : fd(fd), path(path), chunk(chunk), ring(unsigned(depth)), slots(depth) {
+    buffer = file::Stream::mirrored(depth * chunk);
+    window = buffer;
+    for (unsigned long i = 0; i < depth; ++i) {
+        slots[i].data = buffer + i * chunk;
+    }
+}
+
+Stream::ReadAhead::~ReadAhead() {
+    for (; head < next; ++head) {   // Kernel must not write into released buffers
+        retire(head);
+    }
+    ::munmap(buffer, 2 * slots.size() * chunk);
+}
+
+void Stream::ReadAhead::submit(uint64_t index) {
+    auto &slot = this->slot(index);
+    slot.size = 0;
+    slot.iov.iov_base = slot.data;
+    slot.iov.iov_len = chunk;
+    if (ring.available()) {
+        ring.readv(fd, &slot.iov, index * chunk, index);
+        slot.state = Slot::submitted;
+    } else {
+        ::posix_fadvise(fd, index * chunk, chunk, POSIX_FADV_WILLNEED);
+        slot.state = Slot::advised;
+    }
+}
+
+void Stream::ReadAhead::complete() {
+    ring.complete([this](uint64_t index, long result) {
+        auto &slot = this->slot(index);
+        slot.size = result;
+        slot.state = Slot::resident;
+    });
+}
+
+void Stream::ReadAhead::retire(uint64_t index) {
+    auto &slot = this->slot(index);
+    while (slot.state == Slot::submitted) {
+        complete();
+    }
+    slot.state = Slot::idle;
+}
+
+Stream::ReadAhead::Slot &Stream::ReadAhead::wait(uint64_t index) {
+    auto &slot = this->slot(index);
+    if (slot.state == Slot::advised) {
+        slot.size = ::pread(fd, slot.data, chunk, index * chunk);
+        slot.size = slot.size < 0 ? -errno : slot.size;
+        slot.state = Slot::resident;
+    }
+    while (slot.state == Slot::submitted) {
+        complete();
+    }
+    if (slot.size < 0) {
+        throw std::runtime_error(path + ": " + std::strerror(int(-slot.size)));
+    }
+    while (0 < slot.size && slot.size < long(chunk)) { // Short read, complete it or reach the end
+        auto size = ::pread(fd, slot.data + slot.size, chunk - slot.size, index * chunk + slot.size);
+        if (size < 0) {
+            throw std::runtime_error(path + ": " + std::strerror(errno));
+        } else if (size == 0) {
+            break;
+        }
+        slot.size += size;
+    }
+    return slot;
+}
+
+void Stream::ReadAhead::restart(uint64_t index) {
+    for (; head < next; ++head) {
+        retire(head);
+    }
+    head = next = index;
+    ready = index * chunk;
+    while (next < head + slots.size()) {
+        submit(next++);
+    }
+}
+
+void Stream::ReadAhead::fill(uint64_t offset, unsigned long size) {
+    auto index = offset / chunk;
+    if (index < head || index >= next) {
+        restart(index);
+    }
+    for (; head < index; ++head) {  // Chunks left behind free their slots for the ones ahead
+        retire(head);
+        submit(next++);
+    }
+    window = slot(head).data;
+    ready = std::max(ready, head * chunk);
+    auto end = offset + size;
+    if ((end - 1) / chunk >= next) {
+        throw std::runtime_error(SStream() << path << ": peak of " << size << " bytes exceeds the read-ahead window of "
+                                           << slots.size() << " chunks of " << chunk << " bytes");
+    }
+    while (ready < end) {
+        auto &slot = wait(ready / chunk);
+        ready = ready / chunk * chunk + slot.size;
+        if (slot.size < long(chunk)) {
+            break;  // End of file
+        }
+    }
+}
+
+
+
+// Slots cover the largest peak wherever it starts within a chunk
+Stream::Stream(const std::string &path, unsigned long capacity, unsigned long depth, unsigned long chunk)
+    : input::file::Stream(path, 0) {
+    auto page = (unsigned long)::sysconf(_SC_PAGESIZE);
+    chunk = std::max(page, (chunk + page - 1) / page * page);
+    depth = std::max(depth, (capacity + chunk - 1) / chunk + 1);
+    ahead.reset(new ReadAhead(file.fd, file.path, depth, chunk));
+}
+
+Stream::~Stream() {}
+
+bool Stream::asynchronous() const {
+    return ahead->ring.available();
+}
+
+const char *Stream::peak(unsigned long size) {
+    if (file.offset + size > ahead->ready) {
+        ahead->fill(file.offset, size);
+        if (file.offset + size > ahead->ready) {
+            throw EndOfStream(file.path + ": end of stream");
+        }
+    }
+    return ahead->at(file.offset);
+}
+
+Blob &Stream::peak_blob(unsigned long size) {
+    blob._offset = file.offset;
+    blob._size = size;
+    blob._data = file.offset + size <= ahead->ready ? ahead->at(file.offset) : nullptr;
+    return blob;
+}
+
+Blob &Stream::get_blob(unsigned long size) {
+    Stream::peak_blob(size);
+    file.offset += size;
+    return blob;
+}
+
+
+}}} // namespace bitstream::input::uring
@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <unistd.h>
+#include <bitstream/obstream.h>
+
+
+namespace bitstream {
+namespace output {
+namespace buffered {
+
+
+struct Stream::Sink {
+    virtual ~Sink() {}
+    virtual void write(const char *data, unsigned long size) = 0;
+};
+
+
+namespace sink {
+
+struct OStream: Stream::Sink {
+    std::ostream &out;
+    OStream(std::ostream &out) : out(out) {}
+
+    void write(const char *data, unsigned long size) override {
+        out.write(data, size);
+        out.flush();
+    }
+};
+
+struct Fd: Stream::Sink {
+    int fd;
+    Fd(int fd) : fd(fd) {}
+
+    void write(const char *data, unsigned long size) override {
+        while (size != 0) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::string("write: ") + std::strerror(errno));
+            }
+            data += written;
+            size -= written;
+        }
+    }
+};
+
+} // namespace sink
+
+
+// Unbuffered, everything the ostream formats lands in the stream's buffer
+struct Stream::Streambuf: std::streambuf {
+    Stream &stream;
+    Streambuf(Stream &stream) : stream(stream) {}
+
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            char c = traits_type::to_char_type(ch);
+            stream.append(&c, 1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    std::streamsize xsputn(const char *data, std::streamsize size) override {
+        stream.append(data, size);
+        return size;
+    }
+
+    int sync() override {
+        stream.flush();
+        return 0;
+    }
+};
+
+
+Stream::Stream(std::ostream &out, unsigned long capacity, unsigned long threshold)
+    : std::ostream(nullptr), sink(new sink::OStream(out)), streambuf(new Streambuf(*this)),
+      capacity(capacity), threshold(std::min(threshold, capacity)) {
+    rdbuf(streambuf.get());
+    buffer.reserve(capacity);
+}
+
+Stream::Stream(int fd, unsigned long capacity, unsigned long threshold)
+    : std::ostream(nullptr), sink(new sink::Fd(fd)), streambuf(new Streambuf(*this)),
+      capacity(capacity), threshold(std::min(threshold, capacity)) {
+    rdbuf(streambuf.get());
+    buffer.reserve(capacity);
+}
+
+Stream::~Stream() {
+    try {
+        flush();
+    } catch (...) { // nowhere to report it
+    }
+}
+
+Stream &Stream::operator << (double value) {
+    if (!plain() || precision() != 6) {
+        return format(value);
+    }
+    char digits[32];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6).ptr;
+    return write(digits, end - digits);
+}
+
+Stream &Stream::operator << (std::ostream &(*manipulator)(std::ostream &)) {
+    using Manipulator = std::ostream &(*)(std::ostream &);
+    if (manipulator == Manipulator(std::endl)) {
+        *this << '\n';
+    } else if (manipulator == Manipulator(std::flush)) {
+        flush();
+    } else {
+        manipulator(*this);
+    }
+    return *this;
+}
+
+void Stream::flush() {
+    if (!buffer.empty()) {
+        sink->write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void Stream::pad(unsigned long size) {
+    long padding = width_ - long(size);
+    width_ = 0;
+    if (padding > 0) {
+        if (buffer.size() + padding > capacity) {
+            flush();
+        }
+        buffer.append(padding, ' ');
+    }
+}
+
+
+}}} // namespace bitstream::output::buffered
@@ -0,0 +1,278 @@
+#include <stdexcept>
+#include <bitstream/blob.h>
+#include <bitstream/ojstream.h>
+#include <bitstream/omheader.h>
+#include <bitstream/header.h>
+#include <bitstream/machine/bulk.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#   include <immintrin.h>
+#   define BITSTREAM_SIMD 1
+#endif
+
+
+namespace bitstream {
+namespace output {
+namespace json {
+
+
+namespace {
+
+// Control characters, quote, backslash and anything not ASCII
+inline bool special(char ch) {
+    return uint8_t(ch) < 0x20 || ch == '"' || ch == '\\' || uint8_t(ch) >= 0x80;
+}
+
+const char *find_special_scalar(const char *begin, const char *end) {
+    while (begin != end && !special(*begin)) {
+        ++begin;
+    }
+    return begin;
+}
+
+#ifdef BITSTREAM_SIMD
+
+// Signed compare with 0x20 catches both the control characters and the bytes above 0x7F
+__attribute__((target("sse4.1")))
+const char *find_special_sse41(const char *begin, const char *end) {
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; begin + 16 <= end; begin += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i found = _mm_or_si128(_mm_cmplt_epi8(v, space),
+                        _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+        if (int mask = _mm_movemask_epi8(found)) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return find_special_scalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+const char *find_special_avx2(const char *begin, const char *end) {
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; begin + 32 <= end; begin += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        __m256i found = _mm256_or_si256(_mm256_cmpgt_epi8(space, v),
+                        _mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)));
+        if (unsigned mask = _mm256_movemask_epi8(found)) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+    return find_special_sse41(begin, end);
+}
+
+#endif
+
+const char *find_special(const char *begin, const char *end) {
+#ifdef BITSTREAM_SIMD
+    switch (machine::bulk::isa()) {
+    case machine::bulk::avx2:  return find_special_avx2(begin, end);
+    case machine::bulk::sse41: return find_special_sse41(begin, end);
+    default: break;
+    }
+#endif
+    return find_special_scalar(begin, end);
+}
+
+// Length of the well formed UTF-8 sequence at begin, 0 if there's none
+long utf8(const char *begin, const char *end) {
+    auto byte = [&](long i) { return begin + i < end ? uint8_t(begin[i]) : 0; };
+    auto continuation = [&](long i, uint8_t low = 0x80, uint8_t high = 0xBF) {
+        return low <= byte(i) && byte(i) <= high;
+    };
+
+    uint8_t lead = byte(0);
+    if (0xC2 <= lead && lead <= 0xDF) {
+        return continuation(1) ? 2 : 0;
+    }
+    if (0xE0 <= lead && lead <= 0xEF) {   // No overlongs, no surrogates
+        bool second = lead == 0xE0 ? continuation(1, 0xA0) : lead == 0xED ? continuation(1, 0x80, 0x9F) : continuation(1);
+        return second && continuation(2) ? 3 : 0;
+    }
+    if (0xF0 <= lead && lead <= 0xF4) {   // No overlongs, nothing above U+10FFFF
+        bool second = lead == 0xF0 ? continuation(1, 0x90) : lead == 0xF4 ? continuation(1, 0x80, 0x8F) : continuation(1);
+        return second && continuation(2) && continuation(3) ? 4 : 0;
+    }
+    return 0;
+}
+
+void escape(buffered::Stream &out, uint8_t ch) {
+    static const char hex[] = "0123456789abcdef";
+    switch (ch) {
+    case '"':  out << "\\\""; break;
+    case '\\': out << "\\\\"; break;
+    case '\b': out << "\\b"; break;
+    case '\f': out << "\\f"; break;
+    case '\n': out << "\\n"; break;
+    case '\r': out << "\\r"; break;
+    case '\t': out << "\\t"; break;
+    default: {
+        char code[] = { '\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xF] };
+        out.write(code, sizeof(code));
+    }
+    }
+}
+
+} // namespace
+
+
+void quote(buffered::Stream &out, std::string_view string) {
+    const char *begin = string.data(), *end = begin + string.size();
+    out << '"';
+    while (begin != end) {
+        const char *run = find_special(begin, end);
+        out.write(begin, run - begin);
+        if (run == end) {
+            break;
+        }
+        long length = uint8_t(*run) >= 0x80 ? utf8(run, end) : 0;
+        if (length != 0) {
+            out.write(run, length);
+            begin = run + length;
+        } else {
+            escape(out, uint8_t(*run));
+            begin = run + 1;
+        }
+    }
+    out << '"';
+}
+
+
+Stream::Stream(int fd) : out(fd) {
+}
+
+Stream::Stream(std::ostream &out) : out(out) {
+}
+
+void Stream::close() {
+    for (; open != 0; --open) {
+        out << '}';
+    }
+    out << '\n';
+}
+
+bool Stream::key(const Tag &tag) {
+    if (open != 2) {    // Not within header fields
+        return false;
+    }
+    if (fields) {
+        out << ',';
+    }
+    fields = true;
+    quote(out, tag.name);
+    out << ':';
+    return true;
+}
+
+bool Stream::as_string(const Tag &tag) const {
+    static const auto value = Tag::Formatters::id("value");
+    static const auto fourcc = Tag::Formatters::id("fourcc");
+    static const auto string = Tag::Formatters::id("string");
+    auto how = tag.formatters.get(value);
+    return how == fourcc || how == string;
+}
+
+void Stream::fourcc(uint32_t value) {
+    char code[] = { char(value >> 24), char(value >> 16), char(value >> 8), char(value) };
+    quote(out, std::string_view(code, sizeof(code)));
+}
+
+void Stream::item(const std::string &value) {
+    quote(out, value);
+}
+
+void Stream::string(const Tag &tag, std::string_view value) {
+    if (key(tag)) {
+        quote(out, value);
+    }
+}
+
+void Stream::header(const Tag &tag, const char *buffer) {
+    out << "{\"header\":";
+    quote(out, tag.name);
+    out << ",\"size\":" << tag.size / 8;
+    if (tag.size % 8 != 0) {
+        out << ",\"bits\":" << tag.size % 8;
+    }
+    open = 1;
+}
+
+void Stream::payload(const Tag &tag, const bitstream::Blob &) {
+    out << "{\"payload\":";
+    quote(out, tag.name);
+    out << ",\"size\":" << tag.size / 8;
+    if (tag.size % 8 != 0) {
+        out << ",\"bits\":" << tag.size % 8;
+    }
+    out << ",\"depth\":" << depth << "}\n";
+}
+
+void Stream::event(const Parser::Event::Header &event) {
+    auto header = dynamic_cast<const meta::Header *>(&event.header);
+    if (header) {
+        if (header->output_ellipses(*this)) {
+            return;
+        }
+        header->output_header(*this);
+    }
+    if (open == 0) {
+        out << "{\"header\":null";
+        open = 1;
+    }
+    out << ",\"offset\":" << event.parser.stream.offset() << ",\"depth\":" << depth << ",\"fields\":{";
+    open = 2;
+    fields = false;
+    if (header) {
+        header->output_fields(*this);
+    }
+    close();
+    out.commit();
+}
+
+void Stream::event(const Parser::Event::Payload::Data &event) {
+    auto header = dynamic_cast<const meta::Header *>(&event.header);
+    if (header) {
+        header->output_payload(*this, event.data, event.parser);
+    } else {
+        Tag tag;
+        tag.name = "<Payload>";
+        tag.size = 8 * event.data.size();
+        payload(tag, event.data);
+    }
+    out.commit();
+}
+
+void Stream::event(const Parser::Event::Payload::Boundary::Begin &event) {
+    ++depth;
+}
+
+void Stream::event(const Parser::Event::Payload::Boundary::End &event) {
+    if (--depth == 0) {
+        out.flush();
+    } else {
+        out.commit();
+    }
+}
+
+void Stream::event(const Parser::Event::Exception &event) {
+    if (open != 0) {    // Thrown while within a header
+        close();
+    }
+    out << "{\"error\":";
+    try {
+        throw;
+    } catch (const std::exception &e) {
+        quote(out, std::string("caught parsing exception: ") + e.what());
+    } catch (...) {
+        quote(out, "caught unknown/not parsing exception during parsing.");
+    }
+    out << ",\"depth\":" << depth << "}\n";
+    out.flush();
+}
+
+
+}}} // namespace bitstream::output::json
@@ -0,0 +1,53 @@
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <bitstream/omstream.h>
+
+
+namespace bitstream {
+namespace output {
+namespace meta {
+
+
+namespace {
+
+struct Names {
+    std::mutex mutex;
+    std::unordered_map<std::string, Stream::Tag::Formatters::Id> ids;
+    std::deque<std::string> names;  // References stay valid while growing
+};
+
+Names &names() {
+    static Names names;
+    return names;
+}
+
+} // namespace
+
+
+Stream::Tag::Formatters::Id Stream::Tag::Formatters::id(const std::string &name) {
+    auto &table = names();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.ids.find(name);
+    if (it != table.ids.end()) {
+        return it->second;
+    }
+    table.names.push_back(name);
+    return table.ids[name] = Id(table.names.size() - 1);
+}
+
+Stream::Tag::Formatters::Id Stream::Tag::Formatters::find(const std::string &name) {
+    auto &table = names();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.ids.find(name);
+    return it != table.ids.end() ? it->second : none;
+}
+
+const std::string &Stream::Tag::Formatters::name(Id id) {
+    auto &table = names();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.names.at(id);
+}
+
+
+}}} // namespace bitstream::output::meta
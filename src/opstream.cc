@@ -1,4 +1,5 @@
-#include <iomanip>
+#include <algorithm>
+#include <sstream>
 #include <cctype>
 #include <chrono>
 #include <ctime>
@@ -32,20 +33,25 @@ void Stream::indent(const std::string &pattern, bool in) {
     }
 }
 
-std::ostream &Stream::ierr() {   // indented err
+buffered::Stream &Stream::ierr() {   // indented err
     err << _indentation;
     return err;
 }
 
-std::ostream &Stream::iout(const std::string &pattern) {   // indented out
+buffered::Stream &Stream::iout(const std::string &pattern) {   // indented out
     if (pattern.empty()) {
         out << _indentation;
     } else if (!_indentation.empty()) { // substitute end of indentation with pattern
-        out << _indentation.substr(0, _indentation.size() - pattern.size()) << pattern;
+        out << std::string_view(_indentation).substr(0, _indentation.size() - pattern.size()) << pattern;
     }
     return out;
 }
 
+void Stream::flush() {
+    out.flush();
+    err.flush();
+}
+
 }}}} // namespace bitstream::output::print::indented
 
 
@@ -56,12 +62,33 @@ namespace print {
 
 Stream to_stdout(std::cout, std::cerr);
 
+namespace slot {    // What the formatters format, interned once
+
+using Formatters = Stream::Formatter::Tag::Formatters;
+
+static const Formatters::Id field = Formatters::id("field");
+static const Formatters::Id type = Formatters::id("type");
+static const Formatters::Id name = Formatters::id("name");
+static const Formatters::Id value = Formatters::id("value");
+static const Formatters::Id array_item = Formatters::id("array_item");
+static const Formatters::Id number = Formatters::id("number");
+static const Formatters::Id string = Formatters::id("string");
+static const Formatters::Id array = Formatters::id("array");
+
+} // namespace slot
+
+Stream::FormatterName &Stream::FormatterName::operator = (const std::string &name) {
+    this->name = name;
+    id_ = meta::Stream::Tag::Formatters::id(name.empty() ? "array" : name);  // Before slot:: for to_stdout
+    return *this;
+}
+
 bool Stream::ellipses(long item, long total_items) {
     if (total_items > (ellipses_items.before + ellipses_items.after) &&
             item == ellipses_items.before) {
-        iout() << std::endl;
-        iout() << "..." << std::endl;
-        iout() << std::endl;
+        iout() << '\n';
+        iout() << "..." << '\n';
+        iout() << '\n';
         return true;
     }
     if (ellipses_items.before <= item && item < total_items - ellipses_items.after) {
@@ -71,7 +98,8 @@ bool Stream::ellipses(long item, long total_items) {
 }
 
 void Stream::event(const Parser::Event::Exception &event) {
-    std::ostream &err = (idented_errors ? ierr() : this->err);
+    out.flush();    // keep out and err in order
+    buffered::Stream &err = (idented_errors ? ierr() : this->err);
     err << "Error: ";
     try {
         throw;
@@ -80,15 +108,22 @@ void Stream::event(const Parser::Event::Exception &event) {
     } catch (...) {
         err << "caught unknown/not parsing exception during parsing.";
     }
-    err << std::endl;
+    err << '\n';
+    err.flush();
 }
 
 void Stream::event(const Parser::Event::Payload::Boundary::Begin &event) {
     indent(indentation, true);
+    ++depth;
 }
 
 void Stream::event(const Parser::Event::Payload::Boundary::End &event) {
     indent(indentation, false);
+    if (--depth == 0) {
+        flush();
+    } else {
+        out.commit();
+    }
 }
 
 struct Stream::Meta: meta::header::Stream, meta::field::Stream, meta::payload::Stream {
@@ -121,6 +156,7 @@ struct Stream::Meta: meta::header::Stream, meta::field::Stream, meta::payload::S
     virtual void field(const Tag &tag,  int32_t value) { _field(tag, value); }
     virtual void field(const Tag &tag,  int64_t value) { _field(tag, value); }
     virtual void field(const Tag &tag, const std::string &value) { _field(tag, value); }
+    virtual void field(const Tag &tag, std::string_view value) { _field(tag, value); }
     virtual void field(const Tag &tag, const std::vector< uint8_t> &value) { _field(tag, value); }
     virtual void field(const Tag &tag, const std::vector<uint16_t> &value) { _field(tag, value); }
     virtual void field(const Tag &tag, const std::vector<uint32_t> &value) { _field(tag, value); }
@@ -131,9 +167,11 @@ struct Stream::Meta: meta::header::Stream, meta::field::Stream, meta::payload::S
     virtual void field(const Tag &tag, const std::vector< int64_t> &value) { _field(tag, value); }
     virtual void field(const Tag &tag, const std::vector<std::string> &value) { _field(tag, value); }
 
+    BITSTREAM_META_FIELD_VIEWS(_field)
+
     template <typename Type>
     void _field(const Tag &tag, const Type &value) {
-        registry[tag.formatters.get("field")].field(ps, tag, value);
+        registry[tag.formatters.get(slot::field)].field(ps, tag, value);
     }
 
     virtual void payload(const Tag &tag, const bitstream::Blob &) {
@@ -143,7 +181,7 @@ struct Stream::Meta: meta::header::Stream, meta::field::Stream, meta::payload::S
         if (tag.size % 8 != 0) {
             stream << " and "  << tag.size % 8 << " bits";
         }
-        stream << "]" << std::endl;
+        stream << "]" << '\n';
     }
 };
 
@@ -153,12 +191,12 @@ struct Stream::Brackets {
 
     Brackets(print::Stream &ps, const Parser::Event::Header &event)
         :ps(ps), event(event) {
-        ps.out << " @" << event.parser.stream.offset() << std::endl;
+        ps.out << " @" << event.parser.stream.offset() << '\n';
         ps.indent(ps.fields, true);
     }
     ~Brackets() {
         ps.indent(ps.fields, false);
-        ps.iout() << "}" << std::endl;
+        ps.iout() << "}" << '\n';
     }
 };
 
@@ -173,8 +211,9 @@ void Stream::event(const Parser::Event::Header &event) {
             header->output_fields(meta);
         }
     } else {
-        iout(branching) << "<Header> // @" << event.parser.stream.offset() << std::endl;
+        iout(branching) << "<Header> // @" << event.parser.stream.offset() << '\n';
     }
+    out.commit();
 }
 
 void Stream::event(const Parser::Event::Payload::Data &event) {
@@ -190,11 +229,13 @@ void Stream::event(const Parser::Event::Payload::Data &event) {
             .size = 8 * event.data.size()};
         meta.payload(tag, event.data);
     }
+    out.commit();
 }
 
 
 
-void fourcc(std::ostream &stream, const uint32_t value) {
+template <typename Out>
+void fourcc(Out &stream, const uint32_t value) {
     bool non_printed = false;
     for (int i = sizeof(value) - 1; i >= 0; --i) {
         char ch = char((value >> 8 * i) & uint32_t(0xFF));
@@ -230,6 +271,7 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int32_t value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::string &value) { _field(stream, tag, value); }
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) { _field(stream, tag, value); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) { _field(stream, tag, value); }
@@ -241,26 +283,28 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { _field(stream, tag, value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(_field)
+
     template <typename Type>
     void _field(Stream &stream, const Tag &tag, const Type &value) {
 
         auto &out = stream.iout();
         if (stream.print_field_offset) {
-            out << std::setw(stream.field_offset_width) << std::left;
+            out << buffered::width(stream.field_offset_width);
             out << tag.offset << ": ";
         }
-        out << std::setw(stream.type_width) << std::left;
+        out << buffered::width(stream.type_width);
         if (tag.type.empty()) {
-            registry[tag.formatters.get("type")].field(stream, tag, value);
+            registry[tag.formatters.get(slot::type)].field(stream, tag, value);
         } else {
             out << tag.type;
         }
         out << " ";
-        out << std::setw(stream.name_width) << std::left;
-        registry[tag.formatters.get("name")].field(stream, tag, value);
+        out << buffered::width(stream.name_width);
+        registry[tag.formatters.get(slot::name)].field(stream, tag, value);
         out << ": ";
-        registry[tag.formatters.get("value")].field(stream, tag, value);
-        out << std::endl;
+        registry[tag.formatters.get(slot::value)].field(stream, tag, value);
+        out << '\n';
     }
 
 } static field;
@@ -276,9 +320,8 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int32_t value) { number_type(stream, tag, stream.signed_number); }
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) { number_type(stream, tag, stream.signed_number); }
 
-    virtual void field(Stream &stream, const Tag &tag, const std::string &value) {
-        stream.out << (const std::string &)(SStream() << stream.char_type << "[" << value.size() << "]");
-    }
+    virtual void field(Stream &stream, const Tag &tag, const std::string &value) { string_type(stream, tag, value); }
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) { string_type(stream, tag, value); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) { array_type(stream, tag, stream.unsigned_number, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) { array_type(stream, tag, stream.unsigned_number, value); }
@@ -291,24 +334,29 @@ struct: Stream::Formatter {
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { array_type(stream, tag, stream.char_type + "*", value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(view_type)
+
+    // Built as one string for the width to apply to it all, short enough to stay on stack
+    void string_type(Stream &stream, const Tag &tag, std::string_view value) {
+        stream.out << stream.char_type + "[" + std::to_string(value.size()) + "]";
+    }
+
     void number_type(Stream &stream, const Tag &tag, const std::string &type) {
-        SStream ss;
-        ss << type;
-        if (tag.size != 0) {
-            ss << tag.size;
-        }
-        stream.out << (const std::string &)ss;
+        stream.out << (tag.size != 0 ? type + std::to_string(tag.size) : type);
+    }
+
+    template <typename Type>
+    void view_type(Stream &stream, const Tag &tag, const View<Type> &array) {
+        array_type(stream, tag, std::is_signed<Type>::value ? stream.signed_number : stream.unsigned_number, array);
     }
 
     template <typename Type>
     void array_type(Stream &stream, const Tag &tag, const std::string &type, const Type &array) {
-        SStream ss;
-        ss << type;
+        std::string name = type;
         if (tag.size != 0) {
-            ss << tag.size;
+            name += std::to_string(tag.size);
         }
-        ss << "[" << array.size() << "]";
-        stream.out << (const std::string &)ss;
+        stream.out << name + "[" + std::to_string(array.size()) + "]";
     }
 
 } static type;
@@ -358,6 +406,7 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int32_t value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::string &value) { _field(stream, tag, value); }
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) { _field(stream, tag, value); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) { _field(stream, tag, value); }
@@ -369,6 +418,8 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { _field(stream, tag, value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(_field)
+
     template <typename Type>
     void _field(Stream &stream, const Tag &tag, const Type &value) {
         stream.out << tag.name;
@@ -389,6 +440,7 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int32_t value) { number_field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) { number_field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::string &value) { string_field(stream, tag, value); }
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) { string_field(stream, tag, value); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) { array_field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) { array_field(stream, tag, value); }
@@ -400,19 +452,21 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { array_field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { array_field(stream, tag, value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(array_field)
+
     template <typename Type>
     void number_field(Stream &stream, const Tag &tag, const Type &value) {
-        registry[tag.formatters.get("number")].field(stream, tag, value);
+        registry[tag.formatters.get(slot::number)].field(stream, tag, value);
     }
 
     template <typename Type>
     void string_field(Stream &stream, const Tag &tag, const Type &value) {
-        registry[tag.formatters.get("string")].field(stream, tag, value);
+        registry[tag.formatters.get(slot::string)].field(stream, tag, value);
     }
 
     template <typename Type>
     void array_field(Stream &stream, const Tag &tag, const Type &value) {
-        registry[tag.formatters.get("array", stream.default_array_formatter)].field(stream, tag, value);
+        registry[tag.formatters.get(slot::array, stream.default_array_formatter.id())].field(stream, tag, value);
     }
 
 } static value;
@@ -465,25 +519,32 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag,  int64_t value) { error(stream, "number"); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::string &value) { _field(stream, tag, value); }
+    virtual void field(Stream &stream, const Tag &tag, std::string_view value) { _field(stream, tag, value); }
 
     virtual void field(Stream &stream, const Tag &tag, const std::vector< uint8_t> &value) {
-        _field(stream, tag, std::string(value.begin(), value.end()));
+        _field(stream, tag, std::string_view(reinterpret_cast<const char *>(value.data()), value.size()));
     }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint16_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint32_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<uint64_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<  int8_t> &value) {
-        _field(stream, tag, std::string(value.begin(), value.end()));
+        _field(stream, tag, std::string_view(reinterpret_cast<const char *>(value.data()), value.size()));
     }
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int16_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int32_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { error(stream, "array"); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { error(stream, "array"); }
 
-    void _field(Stream &stream, const Tag &tag, const std::string &value) {
+    void _field(Stream &stream, const Tag &tag, std::string_view value) {
         stream.out << '"';
-        for (auto ch: value) {
-            stream.out << (std::isprint(ch) ? ch: stream.non_printing_char);
+        while (!value.empty()) {    // printable runs are written at once
+            auto printable = std::find_if_not(value.begin(), value.end(), [](char ch) { return std::isprint(ch); });
+            stream.out << value.substr(0, printable - value.begin());
+            if (printable == value.end()) {
+                break;
+            }
+            stream.out << stream.non_printing_char;
+            value.remove_prefix(printable - value.begin() + 1);
         }
         stream.out << '"';
     }
@@ -518,15 +579,23 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { _field(stream, tag, value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(_field)
+
     template <typename Type>
     void _field(Stream &stream, const Tag &tag, const Type &array) {
+        auto &item = registry[tag.formatters.get(slot::array_item)];
         stream.out << "[";
-        for (auto i = 0; i < array.size(); ++i){
+        for (long i = 0; i < long(array.size()); ++i){
             if (i != 0) {
                 stream.out << ", ";
             }
+            if (stream.array_ellipsis(i, array.size())) {
+                stream.out << "...";
+                i = array.size() - stream.ellipses_items.after - 1;
+                continue;
+            }
             const auto &value = array[i];
-            registry[tag.formatters.get("array_item")].field(stream, tag, value);
+            item.field(stream, tag, value);
         }
         stream.out << "]";
     }
@@ -561,22 +630,30 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { _field(stream, tag, value); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(_field)
+
     template <typename Type>
     void _field(Stream &stream, const Tag &tag, const Type &array) {
+        auto &item = registry[tag.formatters.get(slot::array_item)];
         stream.out << "[";
         {
             Stream::Indent indent(stream, stream.multiline_array_item_indent);
-            for (auto i = 0; i < array.size(); ++i){
+            for (long i = 0; i < long(array.size()); ++i){
                 if (i != 0) {
                     stream.out << ",";
                 }
-                stream.out << std::endl;
+                stream.out << '\n';
                 stream.iout();
+                if (stream.array_ellipsis(i, array.size())) {
+                    stream.out << "...";
+                    i = array.size() - stream.ellipses_items.after - 1;
+                    continue;
+                }
                 const auto &value = array[i];
-                registry[tag.formatters.get("array_item")].field(stream, tag, value);
+                item.field(stream, tag, value);
             }
         }
-        stream.out << std::endl;
+        stream.out << '\n';
         stream.iout() << "]";
     }
 
@@ -588,13 +665,13 @@ struct: Stream::Formatter {
 
 
 
-template <typename T>
-static std::string ISO_639_2_T_code(const std::vector<T> &array) {
+template <typename Array>
+static std::string ISO_639_2_T_code(const Array &array) {
     std::string code;
-    for (auto i = 0; i < array.size(); ++i) {
+    for (unsigned long i = 0; i < array.size(); ++i) {
         static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";//\0
         auto number = array[i];
-        if (0 < number && number <= sizeof(alphabet) - 1) { // -1 -> '\0'
+        if (0 < number && uint64_t(number) <= sizeof(alphabet) - 1) { // -1 -> '\0'
             code += alphabet[number - 1];
         } else {
             code += '?';
@@ -635,6 +712,8 @@ struct: Stream::Formatter {
     virtual void field(Stream &stream, const Tag &tag, const std::vector< int64_t> &value) { _field(stream, tag, value); }
     virtual void field(Stream &stream, const Tag &tag, const std::vector<std::string> &value) { error(stream); }
 
+    BITSTREAM_PRINT_FORMATTER_VIEWS(_field)
+
     template <typename Type>
     void _field(Stream &stream, const Tag &tag, const Type &array) {
 
@@ -645,7 +724,7 @@ struct: Stream::Formatter {
 
         std::string code = ISO_639_2_T_code(array);
         if (code.find('?') != std::string::npos) {
-            registry[tag.formatters.get("array")].field(stream, tag, array);
+            registry[tag.formatters.get(slot::array)].field(stream, tag, array);
         } else {
             stream.out << code;
             std::string name = ISO_639_2_T_name(code);
@@ -752,15 +831,27 @@ struct: Stream::Formatter {
 
 
 Stream::Formatter& Stream::Formatter::Registry::operator [] (const std::string &name) {
-    auto it = formatters.find(name);
-    if (it == formatters.end()) {
-        throw std::runtime_error(SStream() << "Couldn't find '" << name << "' formatter");
+    auto id = Tag::Formatters::find(name);     // Names never added aren't interned
+    if (id >= formatters.size() || formatters[id] == nullptr) {
+        missing(name);
     }
-    return *(it->second);
+    return *formatters[id];
+}
+
+void Stream::Formatter::Registry::missing(Id id) const {
+    missing(Tag::Formatters::name(id));
+}
+
+void Stream::Formatter::Registry::missing(const std::string &name) const {
+    throw std::runtime_error(SStream() << "Couldn't find '" << name << "' formatter");
 }
 
 void Stream::Formatter::Registry::add(const std::string &name, Stream::Formatter &formatter) {
-    formatters[name] = &formatter;
+    auto id = Tag::Formatters::id(name);
+    if (id >= formatters.size()) {
+        formatters.resize(id + 1);
+    }
+    formatters[id] = &formatter;
 }
 
 Stream::Formatter::Registry::Registry() {
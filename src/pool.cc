@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <bitstream/pool.h>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+Pool::Pool(unsigned threads, unsigned long capacity)
+    : capacity(std::max(capacity, 1UL)) {
+    threads = std::max(threads, 1U);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(new Worker);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers[i]->thread = std::thread(&Pool::work, this, i);
+    }
+}
+
+Pool::~Pool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return queued == 0 && running == 0; });
+        stopping = true;
+    }
+    not_empty.notify_all();
+    for (auto &worker: workers) {
+        worker->thread.join();
+    }
+}
+
+void Pool::submit(Task task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return queued < capacity; });
+        ++queued;
+    }
+    auto &worker = *workers[next++ % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    not_empty.notify_one();
+}
+
+void Pool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return queued == 0 && running == 0; });
+    if (error) {
+        auto error = this->error;
+        this->error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool Pool::pop(unsigned index, Task &task) {
+    for (unsigned i = 0; i < workers.size(); ++i) {
+        auto &worker = *workers[(index + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            if (i == 0) {   // Own tasks in order
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            } else {        // Steal the latest submitted ones
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void Pool::work(unsigned index) {
+    for (;;) {
+        Task task;
+        if (pop(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --queued;
+                ++running;
+            }
+            not_full.notify_one();
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--running == 0 && queued == 0) {
+                idle.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        if (queued != 0) {  // Being pushed right now, or just taken by another worker
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        not_empty.wait(lock, [this] { return stopping || queued != 0; });
+    }
+}
+
+
+}} // namespace bitstream::parallel
@@ -0,0 +1,94 @@
+#include <mutex>
+#include <bitstream/blob.h>
+#include <bitstream/immstream.h>
+#include <bitstream/pool.h>
+#include <bitstream/splitter.h>
+
+
+namespace bitstream {
+namespace parallel {
+
+
+Splitter::Splitter(Indexer indexer, ParserFactory parser, ObserverFactory observer, unsigned threads, uint64_t grain)
+    : indexer(indexer), parser(parser), observer(observer), threads(threads), grain(grain) {}
+
+std::vector<Splitter::Range> Splitter::index(bitstream::Stream &stream, Remainder remainder) const {
+    std::vector<Range> ranges;
+    while (remainder != 0) {
+        auto offset = stream.offset();
+        uint64_t size;
+        try {
+            size = indexer(stream);
+        } catch (const bitstream::Stream::EndOfStream &) {
+            if (stream.offset() != offset) {
+                throw;
+            }
+            break;
+        }
+        auto consumed = stream.offset() - offset;
+        if (size < consumed) {
+            throw Parser::Exception("unit is smaller than its header");
+        }
+        remainder.reduce(size, [] { return Parser::Exception("unit exceeds the stream"); });
+        stream.get_blob(size - consumed);
+
+        if (ranges.empty() || ranges.back().size >= grain) {
+            ranges.emplace_back();
+            ranges.back().offset = offset;
+        }
+        ranges.back().size += size;
+        ranges.back().units += 1;
+    }
+    return ranges;
+}
+
+std::vector<Splitter::Result> Splitter::run(const input::memory::Stream &stream, Merge merge) const {
+    input::memory::Slice whole(stream, stream.offset(), stream.size() - stream.offset());
+    auto ranges = index(whole, stream.size() - stream.offset());
+
+    std::vector<Result> results(ranges.size());
+    std::vector<bool> done(ranges.size());
+    unsigned long merged = 0;
+    std::mutex mutex;
+
+    Pool pool(threads, 2 * threads);
+    for (unsigned long i = 0; i < ranges.size(); ++i) {
+        pool.submit([&, i] {
+            auto &result = results[i];
+            result.range = ranges[i];
+            try {
+                input::memory::Slice slice(stream, result.range.offset, result.range.size);
+                result.observer = observer(result.range);
+                auto parser = this->parser(slice, *result.observer);
+                try {
+                    parser->parse(Remainder(result.range.size));
+                } catch (...) {
+                    result.exception = std::current_exception();
+                    Parser::Event::Exception{*parser};
+                }
+            } catch (...) {
+                if (!result.exception) {
+                    result.exception = std::current_exception();
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);    // Whoever completes the prefix merges it
+            done[i] = true;
+            for (; merged < done.size() && done[merged]; ++merged) {
+                if (merge) {
+                    merge(results[merged]);
+                }
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+std::vector<Splitter::Result> Splitter::run(const std::string &path, Merge merge) const {
+    input::mmap::Stream stream(path, input::mmap::Stream::normal);
+    return run(stream, merge);
+}
+
+
+}} // namespace bitstream::parallel
@@ -0,0 +1,367 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <bitstream/array.h>
+#include <bitstream/string.h>
+
+
+using bitstream::Endianness;
+namespace bulk = bitstream::machine::bulk;
+
+
+// Compares decode_into with item by item decoding for every instruction set available
+template <long size, long offset, Endianness endianness, typename signedness>
+void check_decode(unsigned long items) {
+    using Array = bitstream::Array<bitstream::Field<size, offset, endianness, signedness>>;
+    using Type = typename Array::Type;
+
+    std::vector<char> data((offset + size * items) / 8 + 9);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7 + (i >> 3));
+    }
+    Array array(data.data() + 1, items);
+    std::vector<Type> expected;
+    for (unsigned long i = 0; i < items; ++i) {
+        expected.push_back(array[i]);
+    }
+
+    auto previous = bulk::isa();
+    auto previous_bmi2 = bulk::bmi2();
+    for (auto isa: {bulk::scalar, bulk::sse41, bulk::avx2}) {
+        for (auto bmi2: {false, true}) {
+            bulk::isa(isa);
+            bulk::bmi2(bmi2);
+            std::vector<Type> decoded(items + 1, Type(0x5A));
+            array.decode_into(decoded.data());
+            ASSERT_EQ(decoded.back(), Type(0x5A)) << "isa " << isa << " bmi2 " << bmi2 << " wrote past n";
+            decoded.pop_back();
+            ASSERT_EQ(decoded, expected) << "size " << size << " offset " << offset << " isa " << isa << " bmi2 " << bmi2;
+        }
+    }
+    bulk::isa(previous);
+    bulk::bmi2(previous_bmi2);
+    ASSERT_EQ(typename Array::Vector(array), expected);
+}
+
+template <long size, long offset, Endianness endianness, typename signedness>
+void check_decode() {
+    for (unsigned long items: {0, 1, 7, 15, 16, 17, 63, 64, 129, 300}) {
+        check_decode<size, offset, endianness, signedness>(items);
+    }
+}
+
+TEST(Array, decode_aligned) {
+    check_decode<8,  0, Endianness::big,    unsigned>();
+    check_decode<16, 0, Endianness::big,    unsigned>();
+    check_decode<32, 0, Endianness::big,    unsigned>();
+    check_decode<64, 0, Endianness::big,    unsigned>();
+    check_decode<16, 0, Endianness::little, unsigned>();
+    check_decode<32, 0, Endianness::little, unsigned>();
+    check_decode<64, 0, Endianness::little, unsigned>();
+    check_decode<16, 8, Endianness::big,    signed>();
+    check_decode<32, 0, Endianness::big,    signed>();
+}
+
+TEST(Array, decode_packed) {
+    check_decode<1, 0, Endianness::big,    unsigned>();
+    check_decode<2, 0, Endianness::big,    unsigned>();
+    check_decode<4, 0, Endianness::big,    unsigned>();
+    check_decode<1, 8, Endianness::little, unsigned>();
+    check_decode<2, 0, Endianness::little, unsigned>();
+    check_decode<4, 0, Endianness::little, unsigned>();
+}
+
+TEST(Array, decode_generic) {
+    check_decode<4,  0, Endianness::big, signed>();
+    check_decode<12, 0, Endianness::big, unsigned>();
+    check_decode<12, 3, Endianness::big, unsigned>();
+    check_decode<32, 5, Endianness::little, unsigned>();
+}
+
+TEST(Array, decode_spread) {
+    static_assert(bulk::Codec<12, 4, Endianness::big, unsigned>::kernel, "");
+    static_assert(!bulk::Codec<12, 4, Endianness::big, signed>::kernel, "");
+    check_decode<3,  0, Endianness::big,    unsigned>();
+    check_decode<5,  6, Endianness::big,    unsigned>();
+    check_decode<7,  1, Endianness::little, unsigned>();
+    check_decode<4,  3, Endianness::big,    unsigned>();
+    check_decode<8,  3, Endianness::big,    unsigned>();
+    check_decode<9,  0, Endianness::big,    unsigned>();
+    check_decode<12, 4, Endianness::little, unsigned>();
+    check_decode<14, 7, Endianness::big,    unsigned>();
+    check_decode<15, 2, Endianness::big,    unsigned>();
+    check_decode<15, 2, Endianness::little, unsigned>();
+    check_decode<16, 5, Endianness::big,    unsigned>();
+    check_decode<16, 5, Endianness::little, unsigned>();
+}
+
+TEST(StaticArray, decode_into) {
+    const char data[] = { 0x12, 0x34, 0x56, 0x78 };
+    bitstream::Static::Array<bitstream::Field<16, 0, Endianness::big, unsigned>, 2> array(data);
+    uint16_t decoded[2];
+    array.decode_into(decoded);
+    ASSERT_EQ(decoded[0], 0x1234);
+    ASSERT_EQ(decoded[1], 0x5678);
+}
+
+
+// Compares encode_from with item by item encoding, bits around the items have to survive
+template <long size, long offset, Endianness endianness, typename signedness>
+void check_encode(unsigned long items) {
+    using Array = bitstream::Array<bitstream::Field<size, offset, endianness, signedness>>;
+    using Type = typename Array::Type;
+
+    std::vector<Type> values;
+    for (unsigned long i = 0; i < items; ++i) {
+        values.push_back(Type(i * 0x9E3779B97F4A7C15ULL >> 7));
+    }
+    std::vector<char> background((offset + size * items) / 8 + 9);
+    for (unsigned long i = 0; i < background.size(); ++i) {
+        background[i] = char(i * 131 + 7);
+    }
+    auto expected = background;
+    Array array(expected.data() + 1, items);
+    for (unsigned long i = 0; i < items; ++i) {
+        array[i] = values[i];
+    }
+
+    auto previous = bulk::isa();
+    auto previous_bmi2 = bulk::bmi2();
+    for (auto isa: {bulk::scalar, bulk::sse41, bulk::avx2}) {
+        for (auto bmi2: {false, true}) {
+            bulk::isa(isa);
+            bulk::bmi2(bmi2);
+            auto encoded = background;
+            Array array(encoded.data() + 1, items);
+            array.encode_from(values.data(), items);
+            ASSERT_EQ(encoded, expected) << "size " << size << " offset " << offset << " isa " << isa << " bmi2 " << bmi2;
+        }
+    }
+    bulk::isa(previous);
+    bulk::bmi2(previous_bmi2);
+
+    auto assigned = background;
+    Array(assigned.data() + 1, items) = typename Array::Vector(values);
+    ASSERT_EQ(assigned, expected);
+}
+
+template <long size, long offset, Endianness endianness, typename signedness>
+void check_encode() {
+    for (unsigned long items: {0, 1, 7, 15, 16, 17, 63, 64, 129, 300}) {
+        check_encode<size, offset, endianness, signedness>(items);
+    }
+}
+
+TEST(Array, encode_aligned) {
+    check_encode<8,  0, Endianness::big,    unsigned>();
+    check_encode<16, 0, Endianness::big,    unsigned>();
+    check_encode<32, 0, Endianness::big,    unsigned>();
+    check_encode<64, 0, Endianness::big,    unsigned>();
+    check_encode<32, 0, Endianness::little, unsigned>();
+    check_encode<16, 8, Endianness::big,    signed>();
+}
+
+TEST(Array, encode_packed) {
+    check_encode<1, 0, Endianness::big,    unsigned>();
+    check_encode<2, 0, Endianness::big,    unsigned>();
+    check_encode<4, 0, Endianness::big,    unsigned>();
+    check_encode<1, 8, Endianness::little, unsigned>();
+    check_encode<2, 0, Endianness::little, unsigned>();
+    check_encode<4, 0, Endianness::little, unsigned>();
+}
+
+TEST(Array, encode_generic) {
+    check_encode<12, 3, Endianness::big,    unsigned>();
+    check_encode<4,  0, Endianness::big,    signed>();
+}
+
+
+TEST(Array, encode_spread) {
+    check_encode<3,  0, Endianness::big,    unsigned>();
+    check_encode<5,  6, Endianness::little, unsigned>();
+    check_encode<7,  1, Endianness::big,    unsigned>();
+    check_encode<8,  3, Endianness::little, unsigned>();
+    check_encode<12, 4, Endianness::big,    unsigned>();
+    check_encode<12, 4, Endianness::little, unsigned>();
+    check_encode<15, 2, Endianness::big,    unsigned>();
+    check_encode<16, 5, Endianness::big,    unsigned>();
+    check_encode<16, 5, Endianness::little, unsigned>();
+}
+
+
+// Compile time codec at a runtime bit offset
+template <long size, Endianness endianness, typename signedness>
+struct Reference {
+    template <long offset>
+    using Field = bitstream::Field<size, offset, endianness, signedness>;
+    using Type = typename Field<0>::type;
+
+    static Type get(const char *buffer, long bit) {
+        buffer += bit / 8;
+        switch (bit % 8) {
+        case 0: return Field<0>{buffer};
+        case 1: return Field<1>{buffer};
+        case 2: return Field<2>{buffer};
+        case 3: return Field<3>{buffer};
+        case 4: return Field<4>{buffer};
+        case 5: return Field<5>{buffer};
+        case 6: return Field<6>{buffer};
+        default: return Field<7>{buffer};
+        }
+    }
+};
+
+// Runtime offset codec against the compile time one, reading, writing and iterating
+template <long size, long offset, Endianness endianness, typename signedness>
+void check_runtime() {
+    using Array = bitstream::Array<bitstream::Field<size, offset, endianness, signedness>>;
+    using Type = typename Array::Type;
+    using Reference = ::Reference<size, endianness, signedness>;
+    const unsigned long items = 37;
+
+    std::vector<char> data((offset + size * items) / 8 + 17);
+    for (unsigned long i = 0; i < data.size(); ++i) {
+        data[i] = char(i * 131 + 7 + (i >> 3));
+    }
+    Array array(data.data(), items);
+    std::vector<Type> expected;
+    for (unsigned long i = 0; i < items; ++i) {
+        expected.push_back(Reference::get(data.data(), offset + i * size));
+        ASSERT_EQ(Type(array[i]), expected.back()) << "size " << size << " offset " << offset << " item " << i;
+    }
+
+    std::vector<Type> iterated;
+    for (auto value: const_cast<const Array &>(array)) {
+        iterated.push_back(value);
+    }
+    ASSERT_EQ(iterated, expected);
+
+    auto background = data;
+    for (auto item: array) {
+        item = Type(~Type(item));
+    }
+    for (unsigned long i = 0; i < items; ++i) {
+        Type inverted = Reference::get(data.data(), offset + i * size);
+        bitstream::Field<size, 0, endianness, signedness>{background.data()} = Type(~expected[i]);
+        ASSERT_EQ(inverted, Type(bitstream::Field<size, 0, endianness, signedness>{background.data()}));
+    }
+    ASSERT_EQ(array.end(), typename Array::iterator(array[0], items));
+}
+
+TEST(Array, runtime_offset) {
+    check_runtime<1,  3, Endianness::big,    unsigned>();
+    check_runtime<3,  1, Endianness::little, unsigned>();
+    check_runtime<5,  0, Endianness::big,    signed>();
+    check_runtime<12, 3, Endianness::big,    unsigned>();
+    check_runtime<12, 3, Endianness::little, signed>();
+    check_runtime<17, 6, Endianness::big,    signed>();
+    check_runtime<31, 2, Endianness::little, unsigned>();
+    check_runtime<33, 5, Endianness::big,    unsigned>();
+    check_runtime<57, 7, Endianness::big,    unsigned>();
+    check_runtime<58, 3, Endianness::big,    signed>();
+    check_runtime<61, 1, Endianness::little, unsigned>();
+    check_runtime<63, 7, Endianness::big,    unsigned>();
+    check_runtime<64, 3, Endianness::little, signed>();
+    check_runtime<64, 5, Endianness::big,    unsigned>();
+}
+
+
+// Items read and written in place touch nothing past the array: it ends right before a page
+// which faults on any access
+template <long size, long offset, Endianness endianness>
+void check_runtime_bounds() {
+    using Array = bitstream::Array<bitstream::Field<size, offset, endianness, unsigned>>;
+    using Type = typename Array::Type;
+    const long page = sysconf(_SC_PAGESIZE);
+    char *pages = static_cast<char *>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    ASSERT_NE(pages, MAP_FAILED);
+    ASSERT_EQ(mprotect(pages + page, page, PROT_NONE), 0);
+
+    for (unsigned long items = 1; items <= 9; ++items) {
+        const long bytes = (offset + size * items + 7) / 8;
+        Array array(pages + page - bytes, items);
+        for (unsigned long i = 0; i < items; ++i) {
+            array[i] = Type(i % 7 + 1);
+        }
+        std::vector<Type> values(array.begin(), array.end());
+        for (unsigned long i = 0; i < items; ++i) {
+            ASSERT_EQ(values[i], Type(i % 7 + 1)) << "size " << size << " items " << items;
+        }
+    }
+    munmap(pages, 2 * page);
+}
+
+TEST(Array, runtime_offset_bounds) {
+    check_runtime_bounds<3,  1, Endianness::little>();
+    check_runtime_bounds<12, 0, Endianness::big>();
+    check_runtime_bounds<12, 4, Endianness::little>();
+    check_runtime_bounds<17, 6, Endianness::big>();
+    check_runtime_bounds<33, 5, Endianness::big>();
+    check_runtime_bounds<58, 3, Endianness::little>();
+    check_runtime_bounds<64, 5, Endianness::big>();
+}
+
+
+TEST(Array, random_access) {
+    const char data[] = { 0x00, 0x03, 0x00, 0x07, 0x00, 0x07, 0x00, 0x10, 0x01, 0x00 };
+    bitstream::Array<bitstream::be::UInt16<>> array(data, 5);
+    auto range = array.range();
+    ASSERT_EQ(range.size(), 5);
+    ASSERT_EQ(range[3], 0x10);
+    ASSERT_EQ(std::lower_bound(range.begin(), range.end(), 7) - range.begin(), 1);
+    ASSERT_EQ(std::upper_bound(range.begin(), range.end(), 7) - range.begin(), 3);
+    ASSERT_TRUE(std::binary_search(array.begin(), array.end(), 0x100));
+    ASSERT_EQ(std::accumulate(range.begin(), range.end(), 0), 3 + 7 + 7 + 0x10 + 0x100);
+    ASSERT_EQ(std::distance(range.end(), range.begin()), -5);
+    ASSERT_EQ(*(range.end() - 1), 0x100);
+
+    uint64_t sum = 0;
+    for (auto value: array.prefetched<64>()) {
+        sum += value;
+    }
+    ASSERT_EQ(sum, 3 + 7 + 7 + 0x10 + 0x100);
+
+    bitstream::String<> string("key=value", 9);
+    ASSERT_EQ(std::find(string.begin(), string.end(), '=') - string.begin(), 3);
+}
+
+TEST(Array, random_access_packed) {
+    std::vector<char> data(64);
+    bitstream::Array<bitstream::Field<5, 3, Endianness::big, unsigned>> array(data.data(), 90);
+    for (auto i = 0; i < 90; ++i) {
+        array[i] = i / 3;
+    }
+    auto range = array.range();
+    ASSERT_EQ(std::lower_bound(range.begin(), range.end(), 17) - range.begin(), 51);
+    ASSERT_EQ(std::upper_bound(range.begin(), range.end(), 17) - range.begin(), 54);
+    ASSERT_EQ((range.begin() + 60) - (range.begin() + 7), 53);
+    ASSERT_EQ(range.begin()[89], 29);
+    ASSERT_TRUE(range.begin() + 1 > range.begin());
+    ASSERT_EQ(std::count(array.begin(), array.end(), 5), 3);
+}
+
+
+TEST(Bulk, find) {
+    std::vector<char> bytes(200, 'x');
+    bytes[150] = '\0';
+    bytes[170] = '\0';
+    auto previous = bulk::isa();
+    for (auto isa: {bulk::scalar, bulk::sse41, bulk::avx2}) {
+        bulk::isa(isa);
+        for (long bits = 0; bits < 8; ++bits) {
+            // Shift the bytes right by bits into a bit stream
+            std::vector<char> stream(bytes.size() + 1, char(0xA5));
+            for (unsigned long i = 0; i < bytes.size(); ++i) {
+                bitstream::machine::Runtime<8, Endianness::big>::set(stream.data(), bits + 8 * i, bytes[i]);
+            }
+            ASSERT_EQ(bulk::find(stream.data(), 200, '\0', bits), 150) << "bits " << bits << " isa " << isa;
+            ASSERT_EQ(bulk::find(stream.data(), 150, '\0', bits), 150);
+            ASSERT_EQ(bulk::find(stream.data() + 151, 40, '\0', bits), 19);
+            ASSERT_EQ(bulk::find(stream.data(), 3, 'x', bits), 0);
+        }
+    }
+    bulk::isa(previous);
+}
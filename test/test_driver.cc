@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include <fstream>
+#include <bitstream/blob.h>
+#include <bitstream/field.h>
+#include <bitstream/header.h>
+#include <bitstream/parser.h>
+#include <bitstream/pool.h>
+#include <bitstream/driver.h>
+
+
+// Records of a single byte length followed by that many payload bytes
+struct RecordParser: bitstream::Parser {
+
+    struct Record: bitstream::Header {
+        bitstream::be::UInt8<> size;
+    };
+
+    using bitstream::Parser::Parser;
+
+    void parse(bitstream::Remainder = bitstream::Remainder(), bool = false) override {
+        for (;;) {
+            Record record;
+            hstream.reset();
+            try {
+                get(record.size);
+            } catch (const bitstream::Stream::EndOfStream &) {
+                return;
+            }
+            Event::Header{*this, record};
+            stream.get_blob(hstream.consumed());
+            if (record.size == 0) {
+                throw Parser::Exception("empty record");
+            }
+            Event::Payload::Data{*this, record, stream.get_blob(record.size)};
+        }
+    }
+};
+
+struct RecordObserver: bitstream::Parser::Observer {
+    unsigned long records = 0, payload = 0, exceptions = 0;
+
+    void event(const bitstream::Parser::Event::Header &) override { ++records; }
+    void event(const bitstream::Parser::Event::Payload::Data &event) override { payload += event.data.size(); }
+    void event(const bitstream::Parser::Event::Exception &) override { ++exceptions; }
+};
+
+struct DriverFixture: ::testing::Test {
+
+    std::vector<std::string> paths;
+
+    DriverFixture() {
+        for (int i = 0; i < 8; ++i) {
+            paths.push_back("/tmp/5d0f4c1e-driver-" + std::to_string(i) + ".data");
+            std::ofstream file(paths.back());
+            for (int j = 0; j <= i; ++j) {
+                file.put(char(j + 1));
+                file << std::string(j + 1, 'x');
+            }
+        }
+    }
+
+    bitstream::parallel::Driver driver(unsigned threads) {
+        return bitstream::parallel::Driver(
+            [](bitstream::Stream &stream, bitstream::Parser::Observer &observer) {
+                return std::unique_ptr<bitstream::Parser>(new RecordParser(stream, observer));
+            },
+            [](const std::string &) {
+                return std::unique_ptr<bitstream::Parser::Observer>(new RecordObserver);
+            },
+            threads, 2);
+    }
+};
+
+TEST_F(DriverFixture, results) {
+    auto summary = driver(3).run(paths);
+    ASSERT_EQ(summary.results.size(), paths.size());
+    ASSERT_EQ(summary.failed, 0);
+    uint64_t bytes = 0;
+    for (unsigned long i = 0; i < paths.size(); ++i) {
+        auto &result = summary.results[i];
+        auto &observer = static_cast<RecordObserver &>(*result.observer);
+        ASSERT_EQ(result.path, paths[i]);
+        ASSERT_FALSE(result.exception);
+        ASSERT_EQ(observer.records, i + 1);
+        ASSERT_EQ(observer.payload, (i + 1) * (i + 2) / 2);
+        ASSERT_EQ(result.bytes, observer.records + observer.payload);
+        bytes += result.bytes;
+    }
+    ASSERT_EQ(summary.bytes, bytes);
+}
+
+TEST_F(DriverFixture, failures) {
+    { std::ofstream file(paths[1]); file.put(char(0)); }
+    paths.push_back("/tmp/5d0f4c1e-driver-inexisting.data");
+    auto summary = driver(2).run(paths);
+    ASSERT_EQ(summary.failed, 2);
+    ASSERT_TRUE(summary.results[1].exception);
+    ASSERT_EQ(static_cast<RecordObserver &>(*summary.results[1].observer).exceptions, 1);
+    ASSERT_THROW(std::rethrow_exception(summary.results[1].exception), bitstream::Parser::Exception);
+    ASSERT_TRUE(summary.results.back().exception);
+    ASSERT_FALSE(summary.results.back().observer);
+    ASSERT_FALSE(summary.results[0].exception);
+}
+
+TEST(Pool, steal_and_rethrow) {
+    std::atomic<int> done{0};
+    bitstream::parallel::Pool pool(4, 3);
+    for (int i = 0; i < 100; ++i) {
+        pool.submit([&done] { ++done; });
+    }
+    pool.wait();
+    ASSERT_EQ(done, 100);
+    pool.submit([] { throw std::runtime_error("task"); });
+    ASSERT_THROW(pool.wait(), std::runtime_error);
+    pool.wait();
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <bitstream/ifstream.h>
+#include <bitstream/composer.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 
 struct FileStreamFixture: ::testing::Test {
@@ -35,3 +38,128 @@ TEST_F(FileStreamFixture, overget_blob) {
     stream.get_blob(100);
     ASSERT_THROW({ stream.peak(1); }, bitstream::input::file::Stream::EndOfStream);
 }
+
+TEST_F(FileStreamFixture, alignment) {
+    bitstream::input::file::Stream stream(path, 1);
+    ASSERT_EQ(stream.alignment() & (stream.alignment() - 1), 0);
+    ASSERT_EQ(stream.capacity() % stream.alignment(), 0);
+    ASSERT_GE(stream.capacity(), 2 * stream.alignment());
+}
+
+struct FileStreamOptionsFixture: ::testing::Test {
+
+    std::string path = "/tmp/61d7a0c5-2b5e-4f4f-b6cf-8d6e3c0a9b17.data";
+    std::string data;
+
+    FileStreamOptionsFixture() {
+        for (auto i = 0; i < 5 * 4096 + 123; ++i) {
+            data += char('a' + i % 26);
+        }
+        std::ofstream(path).write(data.data(), data.size());
+    }
+
+    void read(unsigned options) {
+        bitstream::input::file::Stream stream(path, 3 * 4096, options);
+        unsigned long offset = 0;
+        for (auto size: {3, 1000, 4093, 5000, 7, 6000, 4096}) {
+            ASSERT_EQ(std::string(stream.peak(size), size), data.substr(offset, size));
+            stream.get_blob(size);
+            offset += size;
+        }
+        stream.get_blob(11);
+        offset += 11;
+        ASSERT_EQ(std::string(stream.peak(data.size() - offset), data.size() - offset), data.substr(offset));
+        stream.get_blob(data.size() - offset);
+        ASSERT_THROW({ stream.peak(1); }, bitstream::input::file::Stream::EndOfStream);
+    }
+};
+
+TEST_F(FileStreamOptionsFixture, direct) {
+    read(bitstream::input::file::Stream::direct_io);
+}
+
+TEST_F(FileStreamOptionsFixture, ring) {
+    bitstream::input::file::Stream stream(path, 1, bitstream::input::file::Stream::ring_buffer);
+    ASSERT_TRUE(stream.ring());
+    read(bitstream::input::file::Stream::ring_buffer);
+}
+
+TEST_F(FileStreamOptionsFixture, direct_ring) {
+    read(bitstream::input::file::Stream::direct_io | bitstream::input::file::Stream::ring_buffer);
+}
+
+TEST_F(FileStreamOptionsFixture, growth) {
+    for (unsigned options: {0, 1, 2, 3}) {
+        bitstream::input::file::Stream stream(path, 1, options, 4 * 4096);
+        auto capacity = stream.capacity();
+        ASSERT_EQ(std::string(stream.peak(10), 10), data.substr(0, 10));
+        stream.get_blob(5);
+        ASSERT_EQ(std::string(stream.peak(3 * 4096), 3 * 4096), data.substr(5, 3 * 4096));
+        ASSERT_GT(stream.capacity(), capacity);
+        ASSERT_LE(stream.capacity(), 4 * 4096);
+        ASSERT_EQ(stream.statistics().largest_peak, 3 * 4096);
+        ASSERT_GE(stream.statistics().high_water_mark, 3 * 4096);
+        ASSERT_GE(stream.statistics().reallocations, 1);
+        ASSERT_THROW({ stream.peak(5 * 4096); }, std::runtime_error);
+    }
+}
+
+TEST_F(FileStreamOptionsFixture, largest_peak_buffered) {
+    bitstream::input::file::Stream stream(path);
+    stream.peak(1);
+    auto buffered = stream.statistics().high_water_mark;
+    ASSERT_GT(buffered, 1);
+    stream.peak(buffered);  // Served without reading
+    ASSERT_EQ(stream.statistics().largest_peak, buffered);
+    ASSERT_EQ(stream.statistics().high_water_mark, buffered);
+}
+
+TEST_F(FileStreamOptionsFixture, growth_relocates_header) {
+    bitstream::input::file::Stream stream(path, 1, 0, 4 * 4096);
+    bitstream::Composer composer(stream);
+    bitstream::be::UInt8<> first, last;
+    bitstream::String<> payload;
+    composer.get(first);
+    composer.get(payload, long(3 * 4096));
+    composer.get(last);
+    ASSERT_GE(stream.statistics().reallocations, 1);
+    ASSERT_EQ(char(first), data[0]);
+    ASSERT_EQ(std::string(payload), data.substr(1, 3 * 4096));
+    ASSERT_EQ(char(last), data[1 + 3 * 4096]);
+}
+
+TEST_F(FileStreamOptionsFixture, blob) {
+    for (unsigned options: {0, 1}) {
+        bitstream::input::file::Stream stream(path, 4096, options);
+        stream.peak(100);
+        auto &resident = stream.get_blob(10);
+        ASSERT_NE(resident.data(), nullptr);
+        ASSERT_EQ(std::string(resident.data(), 10), data.substr(0, 10));
+
+        auto &blob = stream.get_blob(3 * 4096);
+        ASSERT_EQ(blob.data(), nullptr);
+        std::string chunked;
+        for (const auto &chunk: blob.chunks(1000)) {
+            ASSERT_LE(chunk.size, 1000);
+            chunked.append(chunk.data, chunk.size);
+        }
+        ASSERT_EQ(chunked, data.substr(10, 3 * 4096));
+
+        char part[20];
+        ASSERT_EQ(blob.read_into(part, sizeof(part), 5000), sizeof(part));
+        ASSERT_EQ(std::string(part, sizeof(part)), data.substr(10 + 5000, sizeof(part)));
+
+        std::string copy_path = path + ".copy";
+        {
+            std::ofstream truncate(copy_path);
+        }
+        int fd = ::open(copy_path.c_str(), O_WRONLY);
+        ASSERT_EQ(blob.read_into(fd), 3 * 4096);
+        ::close(fd);
+        std::ifstream copy(copy_path);
+        ASSERT_EQ(std::string(std::istreambuf_iterator<char>(copy), {}), data.substr(10, 3 * 4096));
+
+        auto &tail = stream.get_blob(data.size());  // Goes beyond the end of file
+        ASSERT_EQ(tail.read_into(part, sizeof(part), data.size() - 10 - 3 * 4096 - 5), 5);
+    }
+}
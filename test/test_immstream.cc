@@ -0,0 +1,50 @@
+#include <fstream>
+#include <gtest/gtest.h>
+#include <bitstream/immstream.h>
+
+
+struct MmapStreamFixture: ::testing::Test {
+
+    std::string path;
+
+    MmapStreamFixture() {
+        path = "/tmp/5b0c7e62-3f0e-4c1b-9d0a-1b8f3f6f0c2e.data";
+        std::ofstream file(path);
+        char data[] = "123";
+        file.write(data, sizeof(data) - 1);
+    }
+};
+
+TEST(MmapStream, inexisting_path) {
+    ASSERT_THROW({ bitstream::input::mmap::Stream stream("/tmp/9ca56f86-b565-47e2-bf2a-c9a97c08ae63.data"); }, std::exception);
+}
+
+TEST(MmapStream, empty) {
+    std::string path = "/tmp/0e1d3f5a-8a7c-4f43-a0d9-5a6c2a1e7f11.data";
+    std::ofstream{path};
+    bitstream::input::mmap::Stream stream(path);
+    ASSERT_EQ(stream.peak(0), stream.begin());
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::mmap::Stream::EndOfStream);
+}
+
+TEST_F(MmapStreamFixture, peak) {
+    bitstream::input::mmap::Stream stream(path, bitstream::input::mmap::Stream::random);
+    ASSERT_EQ(std::string(stream.peak(3), 3), "123");
+    stream.get_blob(1);
+    ASSERT_EQ(stream.offset(), 1);
+    ASSERT_EQ(std::string(stream.peak(2), 2), "23");
+    ASSERT_EQ(stream.peak(2), stream.begin() + 1);
+    ASSERT_THROW({ stream.peak(3); }, bitstream::input::mmap::Stream::EndOfStream);
+}
+
+TEST_F(MmapStreamFixture, get_blob_small) {
+    bitstream::input::mmap::Stream stream(path);
+    ASSERT_EQ(stream.get_blob(3).size(), 3);
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::mmap::Stream::EndOfStream);
+}
+
+TEST_F(MmapStreamFixture, overget_blob) {
+    bitstream::input::mmap::Stream stream(path);
+    stream.get_blob(100);
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::mmap::Stream::EndOfStream);
+}
@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include <bitstream/imstream.h>
+
+
+TEST(MemoryStream, peak) {
+    const char data[] = "123";
+    bitstream::input::memory::Stream stream(data, sizeof(data) - 1);
+    ASSERT_EQ(stream.peak(3), data);
+    stream.get_blob(1);
+    ASSERT_EQ(stream.offset(), 1);
+    ASSERT_EQ(stream.peak(2), data + 1);
+    ASSERT_THROW({ stream.peak(3); }, bitstream::input::memory::Stream::EndOfStream);
+}
+
+TEST(MemoryStream, blob) {
+    const char data[] = "123";
+    bitstream::input::memory::Stream stream(data, sizeof(data) - 1);
+    stream.get_blob(1);
+    auto &blob = stream.get_blob(2);
+    ASSERT_EQ(blob.data(), data + 1);
+    ASSERT_EQ(blob.size(), 2);
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::memory::Stream::EndOfStream);
+}
+
+TEST(MemoryStream, overget_blob) {
+    const char data[] = "123";
+    bitstream::input::memory::Stream stream(data, sizeof(data) - 1);
+    stream.get_blob(100);
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::memory::Stream::EndOfStream);
+}
+
+TEST(MemoryStream, owning) {
+    bitstream::input::memory::owning::Stream stream(std::vector<char>{'1', '2', '3'});
+    ASSERT_EQ(std::string(stream.peak(3), 3), "123");
+    ASSERT_EQ(stream.get_blob(3).data(), stream.begin());
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::memory::Stream::EndOfStream);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <bitstream/iustream.h>
+
+
+struct UringStreamFixture: ::testing::Test {
+
+    std::string path;
+    std::string data;
+
+    UringStreamFixture() {
+        path = "/tmp/3f6d3c4e-2d0b-4a55-8f5e-6c7b1d2e9a40.data";
+        for (auto i = 0; i < 5 * 4096 + 123; ++i) {
+            data += char('a' + i % 26);
+        }
+        std::ofstream file(path);
+        file.write(data.data(), data.size());
+    }
+};
+
+TEST(UringStream, inexisting_path) {
+    ASSERT_THROW({ bitstream::input::uring::Stream stream("/tmp/9ca56f86-b565-47e2-bf2a-c9a97c08ae63.data"); }, std::exception);
+}
+
+TEST_F(UringStreamFixture, sequential) {
+    bitstream::input::uring::Stream stream(path, 3000, 2, 4096);
+    for (unsigned long offset = 0; offset + 1000 <= data.size(); offset += 1000) {
+        ASSERT_EQ(std::string(stream.peak(1000), 1000), data.substr(offset, 1000));
+        stream.get_blob(1000);
+    }
+    ASSERT_THROW({ stream.peak(1000); }, bitstream::input::uring::Stream::EndOfStream);
+}
+
+TEST_F(UringStreamFixture, skip) {
+    bitstream::input::uring::Stream stream(path, 3000, 2, 4096);
+    ASSERT_EQ(std::string(stream.peak(10), 10), data.substr(0, 10));
+    stream.get_blob(3 * 4096 + 7);
+    ASSERT_EQ(std::string(stream.peak(2000), 2000), data.substr(3 * 4096 + 7, 2000));
+    stream.get_blob(100000);
+    ASSERT_THROW({ stream.peak(1); }, bitstream::input::uring::Stream::EndOfStream);
+}
+
+TEST_F(UringStreamFixture, in_place) {
+    bitstream::input::uring::Stream stream(path, 3000, 2, 4096);
+    stream.get_blob(4000);
+    auto peak = stream.peak(200);   // Straddles the first two chunks
+    ASSERT_EQ(std::string(peak, 200), data.substr(4000, 200));
+    auto &blob = stream.get_blob(200);
+    ASSERT_EQ(blob.data(), peak);
+    auto window = 3 * 4096 - 4200;  // Up to the end of the chunk after next, wrapping around the slots
+    ASSERT_EQ(stream.peak(window), peak + 200);
+    ASSERT_EQ(std::string(stream.peak(window), window), data.substr(4200, window));
+    ASSERT_THROW({ stream.peak(window + 1); }, std::runtime_error);
+    ASSERT_EQ(stream.get_blob(10000).data(), nullptr);
+    ASSERT_EQ(std::string(stream.peak(100), 100), data.substr(14200, 100));
+}
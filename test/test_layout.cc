@@ -0,0 +1,43 @@
+#include <tuple>
+#include <gtest/gtest.h>
+#include <bitstream/layout.h>
+
+
+using namespace bitstream;
+
+template <typename... Fields>
+static void expect_fields(const char *buffer) {
+    using Layout = bitstream::Layout<Fields...>;
+    ASSERT_EQ(Layout::get(buffer), std::make_tuple(Fields(buffer).value()...));
+    auto loaded = Layout::load(buffer);
+    ASSERT_EQ(loaded.template get<0>(), std::get<0>(Layout::get(buffer)));
+}
+
+TEST(Layout, matches_fields) {
+    char buffer[24];
+    for (unsigned seed = 1; seed < 64; ++seed) {
+        for (unsigned i = 0; i < sizeof(buffer); ++i) {
+            buffer[i] = char(i * 131 * seed + seed * 7);
+        }
+        // Full box: version and flags
+        expect_fields<be::UInt8<0>, be::UInt<24, 8>>(buffer);
+        // Word past the start of the buffer, sub-byte and signed fields
+        expect_fields<be::UInt<4, 32>, be::Int<12, 36>, be::UInt<1, 48>, be::Int<15, 49>>(buffer);
+        expect_fields<le::UInt<4, 32>, le::Int<12, 36>, le::UInt<1, 48>, le::Int<15, 49>>(buffer);
+        // Whole 64 bit word in any field order, odd byte count
+        expect_fields<be::UInt32<32>, be::UInt<3, 3>, be::Int<29, 0>>(buffer + 1);
+        expect_fields<le::UInt<3, 3>, le::Int<29, 0>, le::UInt32<32>>(buffer + 1);
+        expect_fields<be::UInt<7, 17>, be::UInt<13, 1>>(buffer);
+        expect_fields<le::UInt<7, 17>, le::UInt<13, 1>>(buffer);
+        expect_fields<be::Int64<0>>(buffer);
+    }
+}
+
+TEST(Layout, footprint) {
+    using Layout = bitstream::Layout<be::UInt<4, 36>, be::UInt16<48>>;
+    static_assert(Layout::first == 4, "");
+    static_assert(Layout::last == 8, "");
+    static_assert(Layout::bytes == 4, "");
+    static_assert(sizeof(Layout::word_t) == 4, "");
+    static_assert(bitstream::Layout<le::UInt<7, 17>, le::UInt<13, 1>>::bytes == 3, "");
+}
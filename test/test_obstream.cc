@@ -0,0 +1,122 @@
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <bitstream/imstream.h>
+#include <bitstream/obstream.h>
+#include <bitstream/opstream.h>
+#include <bitstream/header.h>
+
+
+using bitstream::output::buffered::Stream;
+using bitstream::output::buffered::width;
+
+TEST(buffered_Stream, format) {
+    std::ostringstream out;
+    {
+        Stream stream(out);
+        stream << width(6) << "ab" << "|" << width(2) << "abc" << "|" << width(4) << 42 << "|";
+        stream << uint8_t(65) << int64_t(-7) << ' ' << uint64_t(-1) << std::endl;
+        stream << 0.5 << ' ' << 1.0 / 3 << ' ' << 1e20 << ' ' << 123456789.0 << ' ' << true;
+        ASSERT_EQ(out.str(), "");
+    }
+    std::ostringstream expected;
+    expected << 0.5 << ' ' << 1.0 / 3 << ' ' << 1e20 << ' ' << 123456789.0;
+    ASSERT_EQ(out.str(), "ab    |abc|42  |A-7 18446744073709551615\n" + expected.str() + " 1");
+}
+
+TEST(buffered_Stream, flush_points) {
+    std::ostringstream out;
+    Stream stream(out, 16, 8);
+    stream << "1234567";
+    stream.commit();
+    ASSERT_EQ(out.str(), "");
+    stream << "8";
+    stream.commit();
+    ASSERT_EQ(out.str(), "12345678");
+    ASSERT_EQ(stream.buffered(), 0);
+
+    stream << "0123456789" << "0123456789";   // past capacity
+    ASSERT_EQ(out.str(), "123456780123456789");
+    stream << std::flush;
+    ASSERT_EQ(out.str(), "1234567801234567890123456789");
+}
+
+TEST(buffered_Stream, fd) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    {
+        Stream stream(fds[1]);
+        stream << "fd " << 1;
+    }
+    char buffer[8] = {};
+    ASSERT_EQ(read(fds[0], buffer, sizeof(buffer)), 4);
+    ASSERT_STREQ(buffer, "fd 1");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+template <typename T, typename = void>
+struct streamable: std::false_type {};
+
+template <typename T>
+struct streamable<T, decltype(void(std::declval<Stream &>() << std::declval<T>()))>: std::true_type {};
+
+TEST(buffered_Stream, manipulators) {
+    static_assert(!streamable<const int *>::value, "pointers aren't bools");
+    static_assert(streamable<bool>::value && streamable<long>::value, "");
+
+    std::ostringstream out;
+    Stream stream(out);
+    stream << true << false << std::endl;
+    stream << std::hex << 255 << std::dec << ' ' << 255 << ' ' << std::boolalpha << true << std::noboolalpha;
+    stream << std::setprecision(3) << ' ' << 3.14159 << std::setprecision(6) << ' ' << 3.14159;
+    stream << std::setw(5) << 42 << '|' << std::left << std::setw(4) << "ab" << '|' << std::right;
+    stream << std::setfill('0') << std::setw(3) << 7 << std::setfill(' ') << std::ends;
+    ASSERT_EQ(out.str(), "");
+    stream << std::flush;
+    ASSERT_EQ(out.str(), std::string("10\nff 255 true 3.14 3.14159   42|ab  |007\0", 42));
+}
+
+// Formatters written against std::ostream take the stream as it is
+static void legacy(std::ostream &out, int value) {
+    out << std::setw(4) << std::hex << value << std::dec;
+}
+
+TEST(buffered_Stream, ostream) {
+    std::ostringstream out;
+    Stream stream(out);
+    legacy(stream, 0xab);
+    stream << ' ' << 10;
+    stream.flush();
+    ASSERT_EQ(out.str(), "  ab 10");
+}
+
+
+// Parses a single empty box with an empty payload scope
+struct ScopeParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+    std::ostringstream *out;
+    std::string within;
+
+    void parse(bitstream::Remainder remainder = bitstream::Remainder(), bool = false) override {
+        bitstream::Header header;
+        Event::Header{*this, header};
+        {
+            Event::Payload::Boundary::Scope scope(*this, header, remainder);
+            within = out->str();
+        }
+    }
+};
+
+TEST(buffered_Stream, top_level_boundary_flushes) {
+    std::ostringstream out, err;
+    bitstream::output::print::Stream print(out, err);
+    bitstream::input::memory::Stream stream("", 0);
+    ScopeParser parser(stream, print);
+    parser.out = &out;
+    parser.parse();
+    ASSERT_EQ(parser.within, "");
+    ASSERT_NE(out.str(), "");
+}
@@ -0,0 +1,160 @@
+#include <sstream>
+#include <gtest/gtest.h>
+#include <bitstream/field.h>
+#include <bitstream/header.h>
+#include <bitstream/parser.h>
+#include <bitstream/imstream.h>
+#include <bitstream/omheader.h>
+#include <bitstream/omftag.h>
+#include <bitstream/ojstream.h>
+#include <bitstream/machine/bulk.h>
+
+
+namespace be = bitstream::be;
+namespace meta = bitstream::output::meta;
+namespace bulk = bitstream::machine::bulk;
+
+static std::string escaped(std::string_view string) {
+    std::ostringstream out;
+    bitstream::output::buffered::Stream stream(out);
+    bitstream::output::json::quote(stream, string);
+    stream.flush();
+    return out.str();
+}
+
+TEST(json_Stream, quote) {
+    using namespace std::string_literals;
+    std::string plain(100, 'a');
+    std::string tail = plain + "\"\\\n\t\x01\x1f\x7f" + "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80" + "\xff\xc3(\xed\xa0\x80" + plain;
+    std::string expected = "\"" + plain + "\\\"\\\\\\n\\t\\u0001\\u001f\x7f" + "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80"
+                         + "\\u00ff\\u00c3(\\u00ed\\u00a0\\u0080" + plain + "\"";
+    for (auto limit: { bulk::avx2, bulk::sse41, bulk::scalar }) {
+        auto previous = bulk::isa(limit);
+        EXPECT_EQ(escaped(""), "\"\"");
+        EXPECT_EQ(escaped("a\0b"s), "\"a\\u0000b\"");
+        EXPECT_EQ(escaped(plain), "\"" + plain + "\"");
+        EXPECT_EQ(escaped(tail), expected);
+        bulk::isa(previous);
+    }
+}
+
+
+struct Box: bitstream::Header, meta::Header {
+    static const long bytes = 12;
+
+    be::UInt32<0> size;
+    be::UInt32<32> type;
+    be::UInt16<64>::Static::Array<2> entries;
+
+    Box(const char *data) : size(data), type(data), entries(data) {}
+
+    void output_header(meta::header::Stream &stream) const override {
+        meta::Stream::Tag tag;
+        tag.name = "box";
+        tag.size = 8 * bytes;
+        stream.header(tag, size.buffer());
+    }
+
+    void output_fields(meta::field::Stream &stream) const override {
+        meta::field::tag::Stream fields(stream);
+        fields.tag(size) << "size";
+        fields.tag(type) << "type" << meta::field::tag::Format("fourcc");
+        fields.tag(entries) << "entries";
+        if (size == 0u) {
+            throw bitstream::Parser::Exception("empty box");
+        }
+    }
+};
+
+// A parent box and its child, then whatever follows
+struct BoxParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+    std::ostringstream *out;
+    unsigned long flushed = 0;  // Once the parent's payload ended
+
+    void parse(bitstream::Remainder remainder = bitstream::Remainder(), bool = false) override {
+        try {
+            Box parent(stream.peak(Box::bytes));
+            Event::Header{*this, parent};
+            stream.get_blob(Box::bytes);
+            {
+                Event::Payload::Boundary::Scope scope(*this, parent, remainder);
+                Box child(stream.peak(Box::bytes));
+                Event::Header{*this, child};
+                stream.get_blob(Box::bytes);
+            }
+            flushed = out->str().size();
+            Box last(stream.peak(Box::bytes));
+            Event::Header{*this, last};
+        } catch (...) {
+            Event::Exception{*this};
+        }
+    }
+};
+
+TEST(json_Stream, boxes) {
+    const char data[] =
+        "\x00\x00\x00\x18" "moov" "\x00\x01\x00\x02"
+        "\x00\x00\x00\x0c" "tr\"k" "\x00\x03\x00\x04"
+        "\x00\x00\x00\x00" "free" "\x00\x00\x00\x00";
+    std::ostringstream out;
+    bitstream::output::json::Stream json(out);
+    bitstream::input::memory::Stream stream(data, sizeof(data) - 1);
+    BoxParser parser(stream, json);
+    parser.out = &out;
+    parser.parse();
+    json.flush();
+    ASSERT_EQ(parser.flushed, out.str().find("{\"header\":\"box\",\"size\":12,\"offset\":24"));
+    ASSERT_EQ(out.str(),
+        "{\"header\":\"box\",\"size\":12,\"offset\":0,\"depth\":0,"
+            "\"fields\":{\"size\":24,\"type\":\"moov\",\"entries\":[1,2]}}\n"
+        "{\"header\":\"box\",\"size\":12,\"offset\":12,\"depth\":1,"
+            "\"fields\":{\"size\":12,\"type\":\"tr\\\"k\",\"entries\":[3,4]}}\n"
+        "{\"header\":\"box\",\"size\":12,\"offset\":24,\"depth\":0,"
+            "\"fields\":{\"size\":0,\"type\":\"free\",\"entries\":[0,0]}}\n"
+        "{\"error\":\"caught parsing exception: empty box\",\"depth\":0}\n");
+}
+
+
+// Byte arrays reach the stream as views, formatted as strings they're quoted
+struct Brand: bitstream::Header, meta::Header {
+    be::UInt8<0>::Static::Array<4> major;
+    bitstream::Array<be::UInt8<>> minor;
+
+    Brand(const char *data) : major(data), minor(data + 4, 3) {}
+
+    void output_header(meta::header::Stream &stream) const override {
+        meta::Stream::Tag tag;
+        tag.name = "ftyp";
+        tag.size = 8 * 7;
+        stream.header(tag, major.buffer());
+    }
+
+    void output_fields(meta::field::Stream &stream) const override {
+        meta::field::tag::Stream fields(stream);
+        fields.tag(major) << "major_brand" << meta::field::tag::Format("string");
+        fields.tag(minor) << "minor";
+    }
+};
+
+struct BrandParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+
+    void parse(bitstream::Remainder = bitstream::Remainder(), bool = false) override {
+        Brand brand(stream.peak(7));
+        Event::Header{*this, brand};
+    }
+};
+
+TEST(json_Stream, string_byte_array) {
+    const char data[] = "isom\x01\x02\x03";
+    std::ostringstream out;
+    bitstream::output::json::Stream json(out);
+    bitstream::input::memory::Stream stream(data, sizeof(data) - 1);
+    BrandParser parser(stream, json);
+    parser.parse();
+    json.flush();
+    ASSERT_EQ(out.str(),
+        "{\"header\":\"ftyp\",\"size\":7,\"offset\":0,\"depth\":0,"
+            "\"fields\":{\"major_brand\":\"isom\",\"minor\":[1,2,3]}}\n");
+}
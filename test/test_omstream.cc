@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <bitstream/omftag.h>
+#include <bitstream/opstream.h>
+
+
+using Tag = bitstream::output::meta::Stream::Tag;
+using bitstream::output::meta::field::tag::Format;
+
+TEST(Tag, formatters) {
+    auto value = Tag::Formatters::id("value");
+    auto fourcc = Tag::Formatters::id("fourcc");
+    ASSERT_EQ(Tag::Formatters::id("value"), value);
+    ASSERT_NE(value, fourcc);
+    ASSERT_EQ(Tag::Formatters::name(fourcc), "fourcc");
+
+    Tag tag;
+    ASSERT_TRUE(tag.formatters.empty());
+    ASSERT_EQ(tag.formatters.get(value), value);
+    ASSERT_EQ(tag.formatters.get("array", "oneline_array"), "oneline_array");
+
+    tag << Format("number");
+    tag << Format("fourcc");    // Overrides
+    tag << Format("multiline_array", "array");
+    ASSERT_EQ(tag.formatters.get(value), fourcc);
+    ASSERT_EQ(tag.formatters.get("value"), "fourcc");
+    ASSERT_EQ(tag.formatters.get("array", "oneline_array"), "multiline_array");
+    ASSERT_EQ(tag.formatters.get("name"), "name");
+}
+
+TEST(Tag, registry) {
+    using bitstream::output::print::registry;
+    ASSERT_EQ(&registry[Tag::Formatters::id("fourcc")], &registry["fourcc"]);
+    ASSERT_THROW(registry["no such formatter"], std::runtime_error);
+    ASSERT_THROW(registry[Tag::Formatters::id("no such formatter either")], std::runtime_error);
+    ASSERT_EQ(Tag::Formatters::find("no such formatter"), Tag::Formatters::none);
+    ASSERT_EQ(Tag::Formatters::find("fourcc"), Tag::Formatters::id("fourcc"));
+}
+
+TEST(Tag, default_array_formatter) {
+    using namespace bitstream::output::print;
+    std::ostringstream out, err;
+    Stream stream(out, err, false);
+    ASSERT_TRUE(stream.default_array_formatter.empty());
+    ASSERT_EQ(stream.default_array_formatter.id(), Tag::Formatters::id("array"));
+    stream.default_array_formatter = "multiline_array";
+    ASSERT_EQ(stream.default_array_formatter.id(), Tag::Formatters::id("multiline_array"));
+    ASSERT_EQ(static_cast<const std::string &>(stream.default_array_formatter), "multiline_array");
+
+    Stream::Formatter::Tag tag;
+    registry["value"].field(stream, tag, std::vector<uint8_t>{1, 2});
+    stream.flush();
+    ASSERT_EQ(out.str(), "[\n    1,\n    2\n]");
+}
+
+
+struct Recorder: bitstream::output::meta::field::Stream {
+    std::vector<const Tag *> tags;
+    std::vector<uint64_t> values;
+
+    void record(const Tag &tag, uint64_t value) { tags.push_back(&tag); values.push_back(value); }
+
+    void field(const Tag &tag,  uint8_t value) override { record(tag, value); }
+    void field(const Tag &tag, uint16_t value) override { record(tag, value); }
+    void field(const Tag &tag, uint32_t value) override { record(tag, value); }
+    void field(const Tag &tag, uint64_t value) override { record(tag, value); }
+    void field(const Tag &tag,   int8_t value) override { record(tag, value); }
+    void field(const Tag &tag,  int16_t value) override { record(tag, value); }
+    void field(const Tag &tag,  int32_t value) override { record(tag, value); }
+    void field(const Tag &tag,  int64_t value) override { record(tag, value); }
+    void field(const Tag &tag, const std::string &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector< uint8_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector<uint16_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector<uint32_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector<uint64_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector<  int8_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector< int16_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector< int32_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector< int64_t> &value) override { record(tag, value.size()); }
+    void field(const Tag &tag, const std::vector<std::string> &value) override { record(tag, value.size()); }
+};
+
+static int definitions = 0;
+
+static void output_fields(bitstream::output::meta::field::Stream &stream, const char *buffer) {
+    using namespace bitstream;
+    output::meta::field::tag::Stream fields(stream);
+    fields.tag(be::UInt8<0>(buffer), [](auto &tag) { ++definitions; tag << "version"; });
+    fields.typed_tag<be::UInt<24, 8>>(be::UInt<24, 8>(buffer).value(), [](auto &tag) {
+        ++definitions;
+        tag << "flags" << Format("fourcc");
+    });
+    fields.tag(be::UInt16<32>::Static::Array<2>(buffer), [](auto &tag) { ++definitions; tag << "entries"; });
+}
+
+TEST(Tag, defined_once) {
+    const char data[] = "\x01\x02\x03\x04\x00\x05\x00\x06";
+    Recorder first, second;
+    output_fields(first, data);
+    output_fields(second, data);
+    ASSERT_EQ(definitions, 3);
+    ASSERT_EQ(first.tags, second.tags);
+    ASSERT_EQ(first.values, std::vector<uint64_t>({1, 0x020304, 2}));
+
+    auto &flags = *first.tags[1];
+    ASSERT_EQ(flags.name, "flags");
+    ASSERT_EQ(flags.size, 24);
+    ASSERT_EQ(flags.offset, 8);
+    ASSERT_EQ(flags.formatters.get("value"), "fourcc");
+    auto &entries = *first.tags[2];
+    ASSERT_EQ(entries.name, "entries");
+    ASSERT_EQ(entries.size, 16);
+    ASSERT_EQ(entries.offset, 32);
+
+    using From = bitstream::output::meta::field::tag::From<bitstream::String<>>;
+    ASSERT_EQ(&From::type(), &From::type());
+    ASSERT_EQ(From::type().formatters.get("value"), "string");
+}
+
+
+TEST(Tag, array_view) {
+    using namespace bitstream;
+    char data[40];
+    for (unsigned i = 0; i < sizeof(data); ++i) {
+        data[i] = char(i * 37 + 11);
+    }
+    be::UInt16<4>::Static::Array<16> array(data);
+    auto view = output::meta::field::tag::To<decltype(array)>::value(array);
+    static_assert(std::is_same<decltype(view), output::meta::Stream::View<uint16_t>>::value, "");
+    ASSERT_EQ(view.size(), 16);
+    ASSERT_EQ(view[15], uint16_t(array[15]));
+    ASSERT_EQ(view.vector(), std::vector<uint16_t>(array));
+
+    Array<le::Int<12>> dynamic(data, 9);
+    auto dynamic_view = output::meta::field::tag::To<decltype(dynamic)>::value(dynamic);
+    ASSERT_EQ(dynamic_view.size(), 9);
+    ASSERT_EQ(dynamic_view[8], int16_t(dynamic[8]));
+    ASSERT_EQ(dynamic_view.vector(), std::vector<int16_t>(dynamic));
+}
+
+TEST(Tag, array_view_print) {
+    using namespace bitstream::output::print;
+    std::vector<uint8_t> items(20);
+    for (unsigned i = 0; i < items.size(); ++i) {
+        items[i] = i;
+    }
+    auto item = [](const void *array, unsigned long index) {
+        return (*static_cast<const std::vector<uint8_t> *>(array))[index];
+    };
+    Stream::Formatter::View<uint8_t> view{&items, items.size(), item, nullptr};
+
+    std::ostringstream out, err;
+    Stream stream(out, err, false);
+    Stream::Formatter::Tag tag;
+    registry["array"].field(stream, tag, view);
+    stream.array_ellipses = true;
+    registry["array"].field(stream, tag, view);
+    stream.ellipses_items.before = 1;
+    stream.ellipses_items.after = 0;
+    registry["multiline_array"].field(stream, tag, view);
+    stream.flush();
+    ASSERT_EQ(out.str(),
+        "[0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19]"
+        "[0, 1, 2, 3, 4, ..., 15, 16, 17, 18, 19]"
+        "[\n    0,\n    ...\n]");
+}
@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+#include <bitstream/parser.h>
+#include <bitstream/imstream.h>
+
+
+struct NullParser: bitstream::Parser {
+    using bitstream::Parser::Parser;
+    void parse(bitstream::Remainder = bitstream::Remainder(), bool = false) override {}
+};
+
+TEST(Parser, find_char) {
+    const char data[] = "name\0more\0";
+    bitstream::input::memory::Stream stream(data, sizeof(data));
+    bitstream::Parser::Observer observer;
+    NullParser parser(stream, observer);
+    ASSERT_EQ(parser.find_char<0>('\0', 10), 4);
+    ASSERT_EQ(parser.find_char<0>('z', 10), -1);
+    ASSERT_EQ(parser.find_char<8>('\0', 9), 3);
+    // "name" shifted by 4 bits: nibbles a|6 e|6 d|6 5|7 0|0
+    const char shifted[] = { 0x06, char(0xE6), 0x16, char(0xD6), 0x50, 0x00, 0x00 };
+    bitstream::input::memory::Stream sstream(shifted, sizeof(shifted));
+    NullParser sparser(sstream, observer);
+    ASSERT_EQ(sparser.find_char<4>('\0', 6), 4);
+    ASSERT_EQ(sparser.find_char<4>('m', 6), 2);
+}
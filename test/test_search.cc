@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include <bitstream/array.h>
+#include <bitstream/search.h>
+
+
+struct SearchFixture: ::testing::Test {
+
+    std::vector<uint32_t> values;
+    std::vector<char> data;
+    bitstream::Array<bitstream::be::UInt32<>> array;
+
+    SearchFixture() {
+        std::mt19937 random(7);
+        uint32_t value = 0;
+        for (int i = 0; i < 1000; ++i) {
+            value += random() % 4;  // Duplicates included
+            values.push_back(value);
+        }
+        data.resize(4 * values.size());
+        array = bitstream::Array<bitstream::be::UInt32<>>(data.data(), values.size());
+        array = values;
+    }
+
+    template <typename lambda>
+    void each_query(lambda check) {
+        for (uint32_t value = 0; value <= values.back() + 2; ++value) {
+            check(value,
+                  long(std::lower_bound(values.begin(), values.end(), value) - values.begin()),
+                  long(std::upper_bound(values.begin(), values.end(), value) - values.begin()));
+        }
+    }
+};
+
+TEST_F(SearchFixture, binary) {
+    each_query([&](uint32_t value, long lower, long upper) {
+        ASSERT_EQ(bitstream::search::lower_bound(array, value), lower) << value;
+        ASSERT_EQ(bitstream::search::upper_bound(array.range(), value), upper) << value;
+    });
+}
+
+TEST_F(SearchFixture, gallop) {
+    each_query([&](uint32_t value, long lower, long) {
+        for (long hint: {0L, 1L, lower - 5, lower, lower + 3, 500L, 999L, 5000L}) {
+            ASSERT_EQ(bitstream::search::gallop(array, value, hint), lower) << value << " from " << hint;
+        }
+    });
+}
+
+TEST_F(SearchFixture, eytzinger) {
+    for (long every: {1, 3, 16, 1000, 2000}) {
+        auto index = bitstream::search::eytzinger(array, every);
+        each_query([&](uint32_t value, long lower, long upper) {
+            ASSERT_EQ(index.lower_bound(value), lower) << value << " every " << every;
+            ASSERT_EQ(index.upper_bound(value), upper) << value << " every " << every;
+        });
+    }
+}
+
+TEST(Search, empty) {
+    bitstream::Array<bitstream::be::UInt32<>> array(nullptr, 0);
+    ASSERT_EQ(bitstream::search::lower_bound(array, 1), 0);
+    ASSERT_EQ(bitstream::search::upper_bound(array, 1), 0);
+    ASSERT_EQ(bitstream::search::gallop(array, 1, 3), 0);
+    ASSERT_EQ(bitstream::search::eytzinger(array).lower_bound(1), 0);
+}
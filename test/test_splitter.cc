@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <bitstream/blob.h>
+#include <bitstream/field.h>
+#include <bitstream/header.h>
+#include <bitstream/parser.h>
+#include <bitstream/splitter.h>
+
+
+// Units of a single byte length followed by that many payload bytes
+struct UnitParser: bitstream::Parser {
+
+    struct Unit: bitstream::Header {
+        bitstream::be::UInt8<> size;
+    };
+
+    using bitstream::Parser::Parser;
+
+    void parse(bitstream::Remainder remainder = bitstream::Remainder(), bool = false) override {
+        while (remainder != 0) {
+            Unit unit;
+            hstream.reset();
+            get(unit.size);
+            stream.get_blob(hstream.consumed());
+            remainder.reduce(1 + unit.size, [] { return Parser::Exception("overcommitment"); });
+            Event::Header{*this, unit};
+            if (unit.size == 0) {
+                throw Parser::Exception("empty unit");
+            }
+            Event::Payload::Data{*this, unit, stream.get_blob(unit.size)};
+        }
+    }
+};
+
+struct UnitObserver: bitstream::Parser::Observer {
+    std::vector<std::pair<uint64_t, unsigned long>> payloads;  // Offset past, size
+    unsigned long exceptions = 0;
+
+    void event(const bitstream::Parser::Event::Payload::Data &event) override {
+        payloads.emplace_back(event.parser.stream.offset(), event.data.size());
+    }
+    void event(const bitstream::Parser::Event::Exception &) override { ++exceptions; }
+};
+
+struct SplitterFixture: ::testing::Test {
+
+    std::vector<char> data;
+
+    SplitterFixture() {
+        for (int i = 0; i < 100; ++i) {
+            data.push_back(char(i % 7 + 1));
+            data.insert(data.end(), i % 7 + 1, char(i));
+        }
+    }
+
+    bitstream::parallel::Splitter splitter(uint64_t grain) {
+        return bitstream::parallel::Splitter(
+            [](bitstream::Stream &stream) {
+                return uint64_t(1 + uint8_t(*stream.peak(1)));
+            },
+            [](bitstream::Stream &stream, bitstream::Parser::Observer &observer) {
+                return std::unique_ptr<bitstream::Parser>(new UnitParser(stream, observer));
+            },
+            [](const bitstream::parallel::Splitter::Range &) {
+                return std::unique_ptr<bitstream::Parser::Observer>(new UnitObserver);
+            },
+            3, grain);
+    }
+};
+
+TEST_F(SplitterFixture, index) {
+    bitstream::input::memory::Stream stream(data.data(), data.size());
+    auto ranges = splitter(16).index(stream);
+    ASSERT_GT(ranges.size(), 1);
+    uint64_t offset = 0;
+    unsigned long units = 0;
+    for (auto &range: ranges) {
+        ASSERT_EQ(range.offset, offset);
+        if (&range != &ranges.back()) {
+            ASSERT_GE(range.size, 16);
+        }
+        offset += range.size;
+        units += range.units;
+    }
+    ASSERT_EQ(offset, data.size());
+    ASSERT_EQ(units, 100);
+}
+
+TEST_F(SplitterFixture, merge_in_order) {
+    UnitObserver sequential;
+    {
+        bitstream::input::memory::Stream stream(data.data(), data.size());
+        UnitParser(stream, sequential).parse(data.size());
+    }
+
+    bitstream::input::memory::Stream stream(data.data(), data.size());
+    UnitObserver merged;
+    uint64_t next = 0;
+    auto results = splitter(10).run(stream, [&](bitstream::parallel::Splitter::Result &result) {
+        ASSERT_EQ(result.range.offset, next);
+        next += result.range.size;
+        auto &payloads = static_cast<UnitObserver &>(*result.observer).payloads;
+        merged.payloads.insert(merged.payloads.end(), payloads.begin(), payloads.end());
+    });
+    ASSERT_GT(results.size(), 1);
+    ASSERT_EQ(next, data.size());
+    ASSERT_EQ(merged.payloads, sequential.payloads);
+}
+
+TEST_F(SplitterFixture, exception) {
+    data.push_back(0);
+    data.push_back(1);
+    data.push_back(2);
+    bitstream::input::memory::Stream stream(data.data(), data.size());
+    auto results = splitter(10).run(stream);
+    ASSERT_TRUE(results.back().exception);
+    ASSERT_EQ(static_cast<UnitObserver &>(*results.back().observer).exceptions, 1);
+    ASSERT_FALSE(results.front().exception);
+}
+
+TEST_F(SplitterFixture, truncated) {
+    data.push_back(5);
+    bitstream::input::memory::Stream stream(data.data(), data.size());
+    ASSERT_THROW(splitter(10).index(stream, data.size()), bitstream::Parser::Exception);
+}
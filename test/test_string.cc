@@ -0,0 +1,59 @@
+#include <sstream>
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <bitstream/string.h>
+#include <bitstream/omftag.h>
+#include <bitstream/opstream.h>
+
+
+TEST(String, view) {
+    const char data[] = "name\0tail";
+    bitstream::String<> string(data, 9);
+    ASSERT_EQ(string.view(), std::string_view(data, 9));
+    ASSERT_EQ(string.view().data(), data);
+    ASSERT_EQ(std::string(string), std::string(string.view()));
+
+    bitstream::CString<> cstring(data, 9);
+    ASSERT_EQ(cstring.view(), "name");
+    ASSERT_EQ(cstring.view().data(), data);
+    ASSERT_EQ(std::string(cstring), "name");
+
+    bitstream::CString<> unterminated(data, 4);
+    ASSERT_EQ(unterminated.view(), "name");
+
+    bitstream::Static::String<4> sstring(data);
+    ASSERT_EQ(sstring.view(), "name");
+    bitstream::Static::CString<9> scstring(data);
+    ASSERT_EQ(scstring.view(), "name");
+    ASSERT_EQ(std::string(scstring), "name");
+}
+
+TEST(String, To) {
+    using namespace bitstream::output::meta::field::tag;
+    const char data[] = "name\0tail";
+    bitstream::String<> string(data, 9);
+    auto view = To<bitstream::String<>>::value(string);
+    static_assert(std::is_same<decltype(view), std::string_view>::value, "");
+    ASSERT_EQ(view, std::string_view(data, 9));
+    ASSERT_EQ(view.data(), data);
+
+    bitstream::Static::CString<9> cstring(data);
+    ASSERT_EQ(To<bitstream::Static::CString<9>>::value(cstring), std::string_view(data, 9));
+
+    bitstream::String<4> unaligned(data, 8);  // Still decoded into a vector
+    static_assert(std::is_same<decltype(To<bitstream::String<4>>::value(unaligned)),
+                               bitstream::String<4>::Vector>::value, "");
+}
+
+TEST(String, format) {
+    using namespace bitstream::output::print;
+    std::ostringstream out, err;
+    Stream stream(out, err, false);
+    Stream::Formatter::Tag tag;
+    const uint8_t bytes[] = { 'a', 'b', 0, 'c' };
+    registry["string"].field(stream, tag, std::string_view("ab\0c", 4));
+    registry["string"].field(stream, tag, std::string("ab\0c", 4));
+    registry["string"].field(stream, tag, std::vector<uint8_t>(bytes, bytes + sizeof(bytes)));
+    stream.flush();
+    ASSERT_EQ(out.str(), "\"ab?c\"\"ab?c\"\"ab?c\"");
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <bitstream/array.h>
+#include <bitstream/views.h>
+
+
+using UInt32s = bitstream::Array<bitstream::be::UInt32<>>;
+
+struct Table {
+    std::vector<char> data;
+    UInt32s array;
+
+    Table(const std::vector<uint32_t> &values) : data(4 * values.size() + 1), array(data.data(), values.size()) {
+        array = values;
+    }
+};
+
+
+TEST(View, prefix_sum) {
+    std::vector<uint32_t> sizes;
+    for (uint32_t i = 0; i < 500; ++i) {
+        sizes.push_back(i % 7 == 0 ? 0 : i % 13 + 1);
+    }
+    Table table(sizes);
+    for (long every: {1, 5, 64, 1000}) {
+        auto offsets = bitstream::view::prefix_sum(table.array, 100, every);
+        ASSERT_EQ(offsets.size(), sizes.size());
+        uint64_t offset = 100;
+        for (unsigned long i = 0; i < sizes.size(); ++i) {
+            ASSERT_EQ(offsets[i], offset);
+            for (uint64_t x = offset; x < offset + sizes[i]; ++x) {
+                ASSERT_EQ(offsets.find(x), i) << x << " every " << every;
+            }
+            offset += sizes[i];
+        }
+        ASSERT_EQ(offsets[sizes.size()], offset);
+        ASSERT_EQ(offsets.total(), offset);
+        ASSERT_EQ(offsets.find(offset), sizes.size());
+        ASSERT_EQ(offsets.find(99), sizes.size());
+    }
+}
+
+TEST(View, runs_counts) {
+    // stts like (sample_count, sample_delta) rows, expanded for reference
+    std::vector<uint32_t> rows;
+    std::vector<uint32_t> expanded;
+    for (uint32_t run = 0; run < 200; ++run) {
+        uint32_t count = run % 5, delta = run % 3 + 1;
+        rows.push_back(count);
+        rows.push_back(delta);
+        expanded.insert(expanded.end(), count, delta);
+    }
+    Table table(rows);
+    for (long every: {1, 7, 64, 1000}) {
+        auto times = bitstream::view::runs(table.array, {}, every);
+        ASSERT_EQ(times.size(), expanded.size());
+        ASSERT_EQ(std::vector<uint32_t>(times.begin(), times.end()), expanded);
+        uint64_t time = 0;
+        for (unsigned long n = 0; n < expanded.size(); ++n) {
+            ASSERT_EQ(times[n], expanded[n]);
+            ASSERT_EQ(times.sum(n), time);
+            for (uint64_t t = time; t < time + expanded[n]; ++t) {
+                ASSERT_EQ(times.find(t), n) << t << " every " << every;
+            }
+            time += expanded[n];
+        }
+        ASSERT_EQ(times.total(), time);
+        ASSERT_EQ(times.find(time), expanded.size());
+    }
+}
+
+TEST(View, runs_starts) {
+    // stsc like (first_chunk, samples_per_chunk, sample_description_index) rows over 10 chunks
+    Table table({1, 4, 1, 3, 2, 1, 4, 0, 1, 8, 5, 1});
+    bitstream::view::Runs<UInt32s>::Layout layout;
+    layout.stride = 3;
+    layout.length = 0;
+    layout.value = 1;
+    layout.encoding = bitstream::view::Runs<UInt32s>::starts;
+    layout.entries = 10;
+    auto chunks = bitstream::view::runs(table.array, layout, 2);
+    std::vector<uint64_t> expected{4, 4, 2, 0, 0, 0, 0, 5, 5, 5};
+    ASSERT_EQ(chunks.size(), 10);
+    ASSERT_EQ(std::vector<uint64_t>(chunks.begin(), chunks.end()), expected);
+    ASSERT_EQ(chunks[7], 5);
+    ASSERT_EQ(chunks.sum(3), 10);   // First sample of the 4th chunk
+    ASSERT_EQ(chunks.find(10), 7);  // Chunk holding the 11th sample
+    ASSERT_EQ(chunks.total(), 25);
+}
+
+TEST(View, empty) {
+    UInt32s array(nullptr, 0);
+    auto runs = bitstream::view::runs(array);
+    ASSERT_EQ(runs.size(), 0);
+    ASSERT_EQ(runs.find(0), 0);
+    ASSERT_TRUE(runs.begin() == runs.end());
+    auto sums = bitstream::view::prefix_sum(array);
+    ASSERT_EQ(sums[0], 0);
+    ASSERT_EQ(sums.find(0), 0);
+}